@@ -0,0 +1,64 @@
+# compresses a file and writes it out as a c++ source defining an embedded_resources::Resource
+#
+# usage: cmake -DINPUT=<file> -DOUTPUT=<file.cpp> -DNAME=<identifier> -P embed_resource.cmake
+#
+# the blob is a gzip stream (zlib's inflate reads it directly), it's generated with cmake so the build doesn't need
+# any extra tools
+
+foreach(var INPUT OUTPUT NAME)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "embed_resource: ${var} is required")
+  endif()
+endforeach()
+
+get_filename_component(output_dir ${OUTPUT} DIRECTORY)
+file(MAKE_DIRECTORY ${output_dir})
+set(compressed "${output_dir}/${NAME}.gz")
+
+file(
+  ARCHIVE_CREATE
+  OUTPUT
+  ${compressed}
+  PATHS
+  ${INPUT}
+  FORMAT
+  raw
+  COMPRESSION
+  GZip
+  COMPRESSION_LEVEL
+  9)
+
+file(SIZE ${INPUT} uncompressed_size)
+file(SIZE ${compressed} compressed_size)
+file(READ ${compressed} hex HEX)
+file(REMOVE ${compressed})
+
+# the gzip header stores when it was compressed (bytes 4-7, MTIME doesn't reach it for raw archives). zero it so the
+# same font always generates the same source
+string(SUBSTRING "${hex}" 0 8 header_start)
+string(SUBSTRING "${hex}" 16 -1 header_end)
+if(NOT header_start STREQUAL "1f8b0800")
+  message(FATAL_ERROR "embed_resource: unexpected gzip header for ${INPUT}")
+endif()
+set(hex "${header_start}00000000${header_end}")
+
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+# wrap lines so the generated file stays readable in a debugger
+string(REPEAT "0x..," 24 line_pattern)
+string(REGEX REPLACE "(${line_pattern})" "\\1\n\t" bytes "${bytes}")
+
+# only the file name, the full path depends on where the tree was checked out
+get_filename_component(input_name ${INPUT} NAME)
+
+file(
+  WRITE ${OUTPUT}
+  "// generated from ${input_name} by embed_resource.cmake, do not edit\n"
+  "#include \"gui/resources/embedded_resources.h\"\n\n"
+  "namespace {\n"
+  "\tconst unsigned char data[] = {\n\t${bytes}\n\t};\n"
+  "}\n\n"
+  "const embedded_resources::Resource embedded_resources::${NAME} = {\n"
+  "\t.data = data,\n"
+  "\t.size = ${compressed_size},\n"
+  "\t.uncompressed_size = ${uncompressed_size},\n"
+  "};\n")
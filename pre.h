@@ -0,0 +1,8 @@
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <cstdio>
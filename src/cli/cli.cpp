@@ -16,11 +16,6 @@ bool cli::run(
 		return false;
 	}
 
-	auto update_res = Blur::check_updates();
-	if (update_res.success && !update_res.is_latest) {
-		u::log("There's a newer version ({}) available at {}!", update_res.latest_tag, update_res.latest_tag_url);
-	}
-
 	bool manual_output_files = !outputs.empty();
 	if (manual_output_files && inputs.size() != outputs.size()) {
 		u::log(L"Input/output filename count mismatch ({} inputs, {} outputs).", inputs.size(), outputs.size());
@@ -47,6 +42,9 @@ bool cli::run(
 		}
 	}
 
+	// reported once rendering's done so it doesn't hold up the first render
+	auto update_check = std::async(std::launch::async, Blur::check_updates);
+
 	for (size_t i = 0; i < inputs.size(); ++i) {
 		std::filesystem::path input_path = std::filesystem::canonical(inputs[i]);
 
@@ -89,9 +87,15 @@ bool cli::run(
 	}
 
 	// render videos
+	startup::trace("rendering");
 	rendering.render_videos();
 
 	u::log(L"Finished rendering");
 
+	auto update_res = update_check.get();
+	if (update_res.success && !update_res.is_latest) {
+		u::log("There's a newer version ({}) available at {}!", update_res.latest_tag, update_res.latest_tag_url);
+	}
+
 	return true;
 }
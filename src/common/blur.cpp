@@ -7,10 +7,16 @@
 #include "config_app.h"
 #include "config_presets.h"
 
-Blur::InitialisationResponse Blur::initialise(bool _verbose, bool _using_preview) {
+void Blur::start_initialisation(bool _verbose, bool _using_preview) {
+	startup::trace("initialisation started");
+
+	verbose = _verbose;
+	using_preview = _using_preview;
+
 	resources_path = u::get_resources_path();
 	settings_path = u::get_settings_path();
 
+	// cheap when they already exist, and everything after this reads them
 	auto global_blur_config_path = config_blur::get_global_config_path();
 	if (!std::filesystem::exists(global_blur_config_path))
 		config_blur::create(global_blur_config_path, BlurSettings{});
@@ -23,6 +29,64 @@ Blur::InitialisationResponse Blur::initialise(bool _verbose, bool _using_preview
 	if (!std::filesystem::exists(preset_config_path))
 		config_presets::create(preset_config_path, PresetSettings{});
 
+	initialise_base_temp_path();
+
+	int res = std::atexit([] {
+		rendering.stop_rendering();
+		blur.cleanup();
+	});
+
+	if (res != 0)
+		DEBUG_LOG("failed to register atexit");
+
+	m_initialisation = startup::Task<InitialisationResponse>("find dependencies", [this] {
+		auto res = find_dependencies();
+		initialised = res.success;
+		return res;
+	});
+
+	// both of these run ffmpeg/vspipe, so they wait on dependencies first
+	m_encoder_probe = startup::Task<bool>("probe encoders", [this] {
+		if (!wait_for_initialisation().success)
+			return false;
+
+		u::get_hardware_encoding_devices();
+		return true;
+	});
+
+	m_rife_gpu_probe = startup::Task<bool>("enumerate rife gpus", [this] {
+		if (!wait_for_initialisation().success)
+			return false;
+
+		initialise_rife_gpus();
+		return true;
+	});
+
+	startup::trace("initialisation tasks queued");
+}
+
+const Blur::InitialisationResponse& Blur::wait_for_initialisation() const {
+	static const InitialisationResponse not_started = {
+		.success = false,
+		.error_message = "Blur not initialised",
+	};
+
+	if (!m_initialisation.started())
+		return not_started;
+
+	return m_initialisation.get();
+}
+
+bool Blur::initialisation_finished() const {
+	return m_initialisation.ready();
+}
+
+Blur::InitialisationResponse Blur::initialise(bool _verbose, bool _using_preview) {
+	start_initialisation(_verbose, _using_preview);
+	return wait_for_initialisation();
+}
+
+Blur::InitialisationResponse Blur::find_dependencies() {
 #if defined(_WIN32)
 	used_installer = std::filesystem::exists(resources_path / "lib\\vapoursynth\\vspipe.exe") &&
 	                 std::filesystem::exists(resources_path / "lib\\ffmpeg\\ffmpeg.exe");
@@ -107,25 +171,6 @@ Blur::InitialisationResponse Blur::initialise(bool _verbose, bool _using_preview
 		}
 	}
 
-	verbose = _verbose;
-	using_preview = _using_preview;
-
-	int res = std::atexit([] {
-		rendering.stop_rendering();
-		blur.cleanup();
-	});
-
-	if (res != 0)
-		DEBUG_LOG("failed to register atexit");
-
-	initialise_base_temp_path();
-
-	initialised = true;
-
-	std::thread([this] {
-		initialise_rife_gpus();
-	}).detach();
-
 	return {
 		.success = true,
 	};
@@ -192,13 +237,17 @@ updates::UpdateCheckRes Blur::check_updates() {
 	if (!config.check_updates)
 		return { .success = false };
 
-	return updates::is_latest_version(config.check_beta);
+	return updates::is_latest_version(
+		config.check_beta, std::chrono::hours(std::max(config.update_check_interval, 0))
+	);
 }
 
 void Blur::update(
-	const std::string& tag, const std::optional<std::function<void(const std::string&)>>& progress_callback
+	const std::string& tag,
+	const std::optional<std::function<void(const std::string&)>>& progress_callback,
+	const std::string& expected_sha256
 ) {
-	updates::update_to_tag(tag, progress_callback);
+	updates::update_to_tag(tag, progress_callback, expected_sha256);
 }
 
 void Blur::initialise_rife_gpus() {
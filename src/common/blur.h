@@ -2,13 +2,14 @@
 
 #include "updates.h"
 #include "config_blur.h"
+#include "startup.h"
 
 const std::string APPLICATION_NAME = "blur";
 const std::string BLUR_VERSION = "2.17";
 
 class Blur { // todo: switch all the classes which could be namespaces into namespaces
 public:
-	bool initialised = false;
+	std::atomic<bool> initialised = false;
 
 	bool verbose = true;
 	bool using_preview = false;
@@ -28,7 +29,14 @@ public:
 		std::string error_message;
 	};
 
-	InitialisationResponse initialise(bool _verbose, bool _using_preview);
+	// starts finding dependencies and probing hardware in the background, returns straight away
+	void start_initialisation(bool _verbose, bool _using_preview);
+
+	// blocks until dependencies have been found. everything that needs ffmpeg/vspipe waits on this
+	const InitialisationResponse& wait_for_initialisation() const;
+	[[nodiscard]] bool initialisation_finished() const;
+
+	InitialisationResponse initialise(bool _verbose, bool _using_preview); // start + wait
 
 	void cleanup() const;
 
@@ -39,15 +47,24 @@ public:
 
 	static updates::UpdateCheckRes check_updates();
 	static void update(
-		const std::string& tag, const std::optional<std::function<void(const std::string&)>>& progress_callback = {}
+		const std::string& tag,
+		const std::optional<std::function<void(const std::string&)>>& progress_callback = {},
+		const std::string& expected_sha256 = ""
 	);
 
 	std::map<int, std::string> rife_gpus;
 	std::vector<std::string> rife_gpu_names;
-	bool initialised_rife_gpus = false;
+	std::atomic<bool> initialised_rife_gpus = false;
 
 	void initialise_rife_gpus();
 	void pick_fastest_rife_gpu(BlurSettings& settings);
+
+private:
+	startup::Task<InitialisationResponse> m_initialisation;
+	startup::Task<bool> m_encoder_probe;
+	startup::Task<bool> m_rife_gpu_probe;
+
+	InitialisationResponse find_dependencies();
 };
 
 inline Blur blur;
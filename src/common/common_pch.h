@@ -22,6 +22,14 @@
 #include <unordered_set>
 #include <ranges>
 #include <cfloat>
+#include <charconv>
+#include <numbers>
+#include <span>
+#include <list>
+#include <deque>
+#include <atomic>
+#include <cstring>
+#include <future>
 
 // libs
 #include <nlohmann/json.hpp>
@@ -29,6 +37,7 @@
 
 #include <boost/process.hpp>
 #include <boost/asio.hpp>
+#include <boost/process/v1/extend.hpp>
 #ifdef _WIN32
 #	include <boost/process/v1/windows.hpp>
 #endif
@@ -38,9 +47,18 @@
 #	include <conio.h>
 #	include <shobjidl.h>
 #	include <Windows.h>
+#	include <psapi.h>
 #elif __APPLE__
 #	include <mach-o/dyld.h>
+#	include <libproc.h>
 #	include <CoreFoundation/CoreFoundation.h>
+#elif __linux__
+#	include <sched.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/file.h>
+#	include <sys/syscall.h>
+#	include <linux/mempolicy.h>
 #endif
 
 // blur
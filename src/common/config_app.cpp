@@ -10,6 +10,11 @@ void config_app::create(const std::filesystem::path& filepath, const GlobalAppSe
 	output << "- updates" << "\n";
 	output << "check for updates: " << (current_settings.check_updates ? "true" : "false") << "\n";
 	output << "include beta updates: " << (current_settings.check_beta ? "true" : "false") << "\n";
+	output << "update check interval (hours): " << current_settings.update_check_interval << "\n";
+
+	output << "\n";
+	output << "- cache" << "\n";
+	output << "index cache size (mb): " << current_settings.index_cache_size << "\n";
 }
 
 GlobalAppSettings config_app::parse(const std::filesystem::path& config_filepath) {
@@ -19,6 +24,8 @@ GlobalAppSettings config_app::parse(const std::filesystem::path& config_filepath
 
 	config_base::extract_config_value(config_map, "check for updates", settings.check_updates);
 	config_base::extract_config_value(config_map, "include beta updates", settings.check_beta);
+	config_base::extract_config_value(config_map, "update check interval (hours)", settings.update_check_interval);
+	config_base::extract_config_value(config_map, "index cache size (mb)", settings.index_cache_size);
 
 	// recreate the config file using the parsed values (keeps nice formatting)
 	create(config_filepath, settings);
@@ -38,5 +45,7 @@ nlohmann::json GlobalAppSettings::to_json() const {
 	nlohmann::json j;
 	j["check_updates"] = this->check_updates;
 	j["check_beta"] = this->check_beta;
+	j["update_check_interval"] = this->update_check_interval;
+	j["index_cache_size"] = this->index_cache_size;
 	return j;
 }
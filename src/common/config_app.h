@@ -3,9 +3,13 @@
 struct GlobalAppSettings {
 	bool check_updates = true;
 	bool check_beta = false;
+	int update_check_interval = 24; // hours, 0 checks on every launch
+
+	int index_cache_size = 2048; // mb
 
 	bool operator==(const GlobalAppSettings& other) const {
-		return check_updates == other.check_updates && check_beta == other.check_beta;
+		return check_updates == other.check_updates && check_beta == other.check_beta &&
+		       update_check_interval == other.update_check_interval && index_cache_size == other.index_cache_size;
 	}
 
 	[[nodiscard]] nlohmann::json to_json() const;
@@ -1,5 +1,6 @@
 #include "config_blur.h"
 #include "config_base.h"
+#include "weighting.h"
 
 void config_blur::create(const std::filesystem::path& filepath, const BlurSettings& current_settings) {
 	std::ofstream output(filepath);
@@ -78,6 +79,12 @@ void config_blur::create(const std::filesystem::path& filepath, const BlurSettin
 		output << "video container: " << current_settings.advanced.video_container << "\n";
 		output << "custom ffmpeg filters: " << current_settings.advanced.ffmpeg_override << "\n";
 		output << "debug: " << (current_settings.advanced.debug ? "true" : "false") << "\n";
+		output << "memory limit (mb): " << current_settings.advanced.memory_limit << "\n";
+		output << "sequential decode: " << (current_settings.advanced.sequential_decode ? "true" : "false") << "\n";
+		output << "auto tune encoder: " << (current_settings.advanced.auto_tune_encoder ? "true" : "false") << "\n";
+		output << "cpu threads: " << current_settings.advanced.cpu_threads << "\n";
+		output << "pin cpu threads: " << (current_settings.advanced.pin_cpu_threads ? "true" : "false") << "\n";
+		output << "numa placement: " << (current_settings.advanced.numa_placement ? "true" : "false") << "\n";
 
 		output << "\n";
 		output << "- advanced blur" << "\n";
@@ -111,6 +118,15 @@ void config_blur::create(const std::filesystem::path& filepath, const BlurSettin
 config_blur::ConfigValidationResponse config_blur::validate(BlurSettings& config, bool fix) {
 	std::set<std::string> errors;
 
+	auto weighting_res = weighting::validate(config);
+	if (!weighting_res.success) {
+		errors.insert(weighting_res.error_message);
+
+		// a function the user wrote is kept so the error can be fixed in it, resetting would throw it away
+		if (fix && weighting::is_custom_weight(config.blur_weighting))
+			config.blur_weighting = DEFAULT_CONFIG.blur_weighting;
+	}
+
 	if (!u::contains(SVP_INTERPOLATION_PRESETS, config.advanced.svp_interpolation_preset)) {
 		errors.insert(
 			std::format("SVP interpolation preset ({}) is not a valid option", config.advanced.svp_interpolation_preset)
@@ -140,6 +156,22 @@ config_blur::ConfigValidationResponse config_blur::validate(BlurSettings& config
 			config.advanced.interpolation_blocksize = DEFAULT_CONFIG.advanced.interpolation_blocksize;
 	}
 
+	if (config.advanced.cpu_threads < 0) {
+		errors.insert(std::format("CPU threads ({}) can't be negative, use 0 for all", config.advanced.cpu_threads));
+
+		if (fix)
+			config.advanced.cpu_threads = DEFAULT_CONFIG.advanced.cpu_threads;
+	}
+
+	if (config.advanced.memory_limit < MIN_MEMORY_LIMIT) {
+		errors.insert(
+			std::format("Memory limit ({}mb) must be at least {}mb", config.advanced.memory_limit, MIN_MEMORY_LIMIT)
+		);
+
+		if (fix)
+			config.advanced.memory_limit = DEFAULT_CONFIG.advanced.memory_limit;
+	}
+
 	return ConfigValidationResponse{
 		.success = errors.empty(),
 		.error = u::join(errors, " "),
@@ -210,6 +242,12 @@ BlurSettings config_blur::parse(const std::filesystem::path& config_filepath) {
 		config_base::extract_config_value(config_map, "video container", settings.advanced.video_container);
 		config_base::extract_config_string(config_map, "custom ffmpeg filters", settings.advanced.ffmpeg_override);
 		config_base::extract_config_value(config_map, "debug", settings.advanced.debug);
+		config_base::extract_config_value(config_map, "memory limit (mb)", settings.advanced.memory_limit);
+		config_base::extract_config_value(config_map, "sequential decode", settings.advanced.sequential_decode);
+		config_base::extract_config_value(config_map, "auto tune encoder", settings.advanced.auto_tune_encoder);
+		config_base::extract_config_value(config_map, "cpu threads", settings.advanced.cpu_threads);
+		config_base::extract_config_value(config_map, "pin cpu threads", settings.advanced.pin_cpu_threads);
+		config_base::extract_config_value(config_map, "numa placement", settings.advanced.numa_placement);
 
 		config_base::extract_config_value(
 			config_map, "blur weighting gaussian std dev", settings.advanced.blur_weighting_gaussian_std_dev
@@ -342,6 +380,8 @@ BlurSettings::ToJsonResult BlurSettings::to_json() const {
 	// j["video_container"] = this->advanced.video_container;
 	// j["ffmpeg_override"] = this->advanced.ffmpeg_override;
 	j["debug"] = this->advanced.debug;
+	j["memory_limit"] = this->advanced.memory_limit;
+	j["sequential_decode"] = this->advanced.sequential_decode;
 
 	j["blur_weighting_gaussian_std_dev"] = this->advanced.blur_weighting_gaussian_std_dev;
 	j["blur_weighting_triangle_reverse"] = this->advanced.blur_weighting_triangle_reverse;
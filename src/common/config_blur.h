@@ -6,6 +6,12 @@ struct AdvancedSettings {
 	std::string deduplicate_threshold = "0.001";
 	std::string ffmpeg_override;
 	bool debug = false;
+	int memory_limit = 4096;
+	bool sequential_decode = false;
+	bool auto_tune_encoder = false;
+	int cpu_threads = 0; // 0 = all
+	bool pin_cpu_threads = false;
+	bool numa_placement = false;
 
 	float blur_weighting_gaussian_std_dev = 2.f;
 	bool blur_weighting_triangle_reverse = false;
@@ -27,7 +33,11 @@ struct AdvancedSettings {
 		// todo: boost? i mean, im already using it partially
 		return video_container == other.video_container && deduplicate_range == other.deduplicate_range &&
 		       deduplicate_threshold == other.deduplicate_threshold && ffmpeg_override == other.ffmpeg_override &&
-		       debug == other.debug && blur_weighting_gaussian_std_dev == other.blur_weighting_gaussian_std_dev &&
+		       debug == other.debug && memory_limit == other.memory_limit &&
+		       sequential_decode == other.sequential_decode && auto_tune_encoder == other.auto_tune_encoder &&
+		       cpu_threads == other.cpu_threads && pin_cpu_threads == other.pin_cpu_threads &&
+		       numa_placement == other.numa_placement &&
+		       blur_weighting_gaussian_std_dev == other.blur_weighting_gaussian_std_dev &&
 		       blur_weighting_triangle_reverse == other.blur_weighting_triangle_reverse &&
 		       blur_weighting_bound == other.blur_weighting_bound &&
 		       svp_interpolation_preset == other.svp_interpolation_preset &&
@@ -144,6 +154,8 @@ namespace config_blur {
 
 	inline const std::vector<std::string> INTERPOLATION_BLOCK_SIZES = { "4", "8", "16", "32" };
 
+	inline const int MIN_MEMORY_LIMIT = 256; // mb
+
 	const std::string CONFIG_FILENAME = ".blur-config.cfg";
 
 	void create(const std::filesystem::path& filepath, const BlurSettings& current_settings = BlurSettings());
@@ -0,0 +1,278 @@
+#include "cpu.h"
+
+namespace {
+	std::string format_cpus(const std::vector<int>& cpus) {
+		if (cpus.empty())
+			return "any";
+
+		// collapse runs into ranges, e.g. 0-5,8
+		std::vector<std::string> parts;
+		for (size_t i = 0; i < cpus.size();) {
+			size_t end = i;
+			while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1)
+				end++;
+
+			parts.push_back(end == i ? std::to_string(cpus[i]) : std::format("{}-{}", cpus[i], cpus[end]));
+			i = end + 1;
+		}
+
+		return u::join(parts, ",");
+	}
+
+	// kernel cpu list format, e.g. "0-7,16-23"
+	std::vector<int> parse_cpu_list(const std::string& list) {
+		std::vector<int> cpus;
+
+		std::stringstream stream(list);
+		std::string part;
+		while (std::getline(stream, part, ',')) {
+			part = u::trim(part);
+			if (part.empty())
+				continue;
+
+			try {
+				auto dash = part.find('-');
+				int first = std::stoi(part.substr(0, dash));
+				int last = dash == std::string::npos ? first : std::stoi(part.substr(dash + 1));
+
+				for (int cpu = first; cpu <= last; cpu++)
+					cpus.push_back(cpu);
+			}
+			catch (...) {
+				return {};
+			}
+		}
+
+		return cpus;
+	}
+
+	// adds step to a counter shared between blur processes and returns its previous value
+	size_t increment_shared_counter(const std::string& name, size_t step) {
+		size_t counter = 0;
+
+#if defined(__linux__)
+		auto counter_path = std::filesystem::temp_directory_path() / name;
+
+		int fd = open(counter_path.c_str(), O_RDWR | O_CREAT, 0666);
+		if (fd != -1) {
+			if (flock(fd, LOCK_EX) == 0) {
+				std::array<char, 32> buffer{};
+				ssize_t length = pread(fd, buffer.data(), buffer.size() - 1, 0);
+				if (length > 0)
+					std::from_chars(buffer.data(), buffer.data() + length, counter);
+
+				auto next = std::to_string(counter + step);
+				if (ftruncate(fd, 0) != 0 || pwrite(fd, next.data(), next.size(), 0) < 0)
+					DEBUG_LOG("failed to update {}", name);
+
+				flock(fd, LOCK_UN);
+			}
+
+			close(fd);
+		}
+#else
+		// no shared lock file elsewhere, at least spread jobs within this process
+		static std::mutex counters_mutex;
+		static std::unordered_map<std::string, size_t> counters;
+
+		std::lock_guard lock(counters_mutex);
+		counter = counters[name];
+		counters[name] = counter + step;
+#endif
+
+		return counter;
+	}
+}
+
+std::vector<int> cpu::CoreSplit::all_cpus() const {
+	std::vector<int> cpus = vapoursynth_cpus;
+	cpus.insert(cpus.end(), encoder_cpus.begin(), encoder_cpus.end());
+
+	std::ranges::sort(cpus);
+	cpus.erase(std::ranges::unique(cpus).begin(), cpus.end());
+
+	return cpus;
+}
+
+std::string cpu::CoreSplit::to_string() const {
+	return std::format(
+		"vapoursynth {} threads (cpus {}), encoder {} threads (cpus {}){}",
+		vapoursynth_threads,
+		format_cpus(vapoursynth_cpus),
+		encoder_threads,
+		format_cpus(encoder_cpus),
+		numa_node ? std::format(", numa node {}", *numa_node) : ""
+	);
+}
+
+std::vector<int> cpu::get_available_cpus() {
+	std::vector<int> cpus;
+
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &set))
+				cpus.push_back(cpu);
+		}
+	}
+#elif defined(_WIN32)
+	DWORD_PTR process_mask = 0;
+	DWORD_PTR system_mask = 0;
+
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+		for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); cpu++) {
+			if (process_mask & (static_cast<DWORD_PTR>(1) << cpu))
+				cpus.push_back(cpu);
+		}
+	}
+#endif
+
+	if (cpus.empty()) {
+		int count = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+		for (int cpu = 0; cpu < count; cpu++)
+			cpus.push_back(cpu);
+	}
+
+	return cpus;
+}
+
+size_t cpu::claim_cpu_offset(int count, std::optional<int> numa_node) {
+	auto name = numa_node ? std::format("blur-cpu-offset-node{}", *numa_node) : std::string("blur-cpu-offset");
+	return increment_shared_counter(name, std::max(1, count));
+}
+
+cpu::CoreSplit cpu::split_cores(
+	const std::vector<int>& cpus, int budget, std::optional<int> encoder_threads, size_t offset
+) {
+	int available = std::max(1, static_cast<int>(cpus.size()));
+	int total = budget > 0 ? std::min(budget, available) : available;
+
+	// the script (decoding, interpolation, blending) does most of the work. give the encoder a quarter by default
+	int encoder = total > 1 ? std::clamp(encoder_threads.value_or(total / 4), 1, total - 1) : 1;
+	int vapoursynth_threads = std::max(1, total - encoder);
+
+	CoreSplit split{
+		.vapoursynth_threads = vapoursynth_threads,
+		.encoder_threads = encoder,
+	};
+
+	if (supports_affinity() && !cpus.empty()) {
+		std::vector<int> budget_cpus;
+		for (size_t i = 0; i < std::min<size_t>(total, cpus.size()); i++)
+			budget_cpus.push_back(cpus[(offset + i) % cpus.size()]);
+		std::ranges::sort(budget_cpus);
+
+		if (total == 1) {
+			split.vapoursynth_cpus = budget_cpus;
+			split.encoder_cpus = budget_cpus;
+		}
+		else {
+			split.vapoursynth_cpus.assign(budget_cpus.begin(), budget_cpus.begin() + vapoursynth_threads);
+			split.encoder_cpus.assign(budget_cpus.begin() + vapoursynth_threads, budget_cpus.end());
+		}
+	}
+
+	return split;
+}
+
+bool cpu::supports_affinity() {
+#if defined(__linux__) || defined(_WIN32)
+	return true;
+#else
+	return false; // macos has no hard affinity api
+#endif
+}
+
+bool cpu::set_affinity(boost::process::child& process, const std::vector<int>& cpus) {
+	if (cpus.empty())
+		return false;
+
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : cpus)
+		CPU_SET(cpu, &set);
+
+	return sched_setaffinity(process.id(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+	DWORD_PTR mask = 0;
+	for (int cpu : cpus) {
+		if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+			mask |= static_cast<DWORD_PTR>(1) << cpu;
+	}
+
+	return SetProcessAffinityMask(process.native_handle(), mask) != 0;
+#else
+	return false;
+#endif
+}
+
+std::vector<cpu::NumaNode> cpu::get_numa_nodes() {
+	std::vector<NumaNode> nodes;
+
+#if defined(__linux__)
+	static const std::regex node_regex(R"(node(\d+))");
+
+	auto available = get_available_cpus();
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+		std::smatch match;
+		std::string name = entry.path().filename().string();
+		if (!std::regex_match(name, match, node_regex))
+			continue;
+
+		std::ifstream cpulist_file(entry.path() / "cpulist");
+		std::string cpulist;
+		if (!std::getline(cpulist_file, cpulist))
+			continue;
+
+		NumaNode node{ .id = std::stoi(match[1]) };
+
+		// only cpus we're allowed to run on, e.g. when blur itself is started under taskset
+		for (int cpu : parse_cpu_list(cpulist)) {
+			if (u::contains(available, cpu))
+				node.cpus.push_back(cpu);
+		}
+
+		if (!node.cpus.empty())
+			nodes.push_back(std::move(node));
+	}
+
+	std::ranges::sort(nodes, {}, &NumaNode::id);
+
+	if (nodes.size() < 2)
+		nodes.clear();
+#endif
+
+	return nodes;
+}
+
+std::optional<cpu::NumaNode> cpu::pick_numa_node() {
+	auto nodes = get_numa_nodes();
+	if (nodes.empty())
+		return {};
+
+	size_t counter = increment_shared_counter("blur-numa-counter", 1);
+
+	return nodes[counter % nodes.size()];
+}
+
+#if defined(__linux__)
+void cpu::bind_memory_to_node(int node) {
+	// called between fork and exec so only async-signal-safe calls here. glibc doesn't wrap set_mempolicy and
+	// libnuma isn't a dependency, so use the syscall directly
+	constexpr int bits_per_word = sizeof(unsigned long) * 8;
+
+	std::array<unsigned long, 16> mask{};
+	if (node < 0 || node >= static_cast<int>(mask.size()) * bits_per_word)
+		return;
+
+	mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+
+	syscall(SYS_set_mempolicy, MPOL_BIND, mask.data(), mask.size() * bits_per_word + 1);
+}
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+// splits the cpu between vapoursynth and the encoder so they don't both try to use every core and fight over them
+namespace cpu {
+	struct CoreSplit {
+		int vapoursynth_threads;
+		int encoder_threads;
+
+		// used when pinning, empty if pinning isn't supported
+		std::vector<int> vapoursynth_cpus;
+		std::vector<int> encoder_cpus;
+
+		std::optional<int> numa_node;
+
+		// vapoursynth and encoder cpus combined, sorted and without duplicates
+		[[nodiscard]] std::vector<int> all_cpus() const;
+
+		[[nodiscard]] std::string to_string() const;
+	};
+
+	struct NumaNode {
+		int id;
+		std::vector<int> cpus;
+	};
+
+	// nodes from /sys/devices/system/node that have cpus we're allowed to use. empty on single node machines and
+	// outside linux
+	std::vector<NumaNode> get_numa_nodes();
+
+	// spreads render jobs across numa nodes round-robin. the counter is shared between blur processes so concurrent
+	// jobs land on different nodes
+	std::optional<NumaNode> pick_numa_node();
+
+	// cpus this process is allowed to run on
+	std::vector<int> get_available_cpus();
+
+	// hands out blocks of count cpus round-robin, returning where the next block starts. like pick_numa_node the
+	// counter is shared between blur processes (one per numa node), so concurrent pinned jobs don't all start at
+	// the first cpu
+	size_t claim_cpu_offset(int count, std::optional<int> numa_node = {});
+
+	// budget of 0 uses every available cpu. encoder_threads overrides the default share given to the encoder. pinned
+	// cpus are taken starting at offset, wrapping around
+	CoreSplit split_cores(
+		const std::vector<int>& cpus, int budget, std::optional<int> encoder_threads = {}, size_t offset = 0
+	);
+
+	bool supports_affinity();
+
+#if defined(__linux__)
+	void bind_memory_to_node(int node);
+
+	// boost.process initialiser which pins the child to the given cpus (and optionally binds its memory to a numa
+	// node) before it execs
+	struct Affinity : boost::process::extend::handler {
+		std::vector<int> cpus;
+		std::optional<int> memory_node;
+
+		explicit Affinity(std::vector<int> cpus, std::optional<int> memory_node = {})
+			: cpus(std::move(cpus)), memory_node(memory_node) {}
+
+		template<typename Executor>
+		void on_exec_setup(Executor& /*exec*/) const {
+			if (memory_node)
+				bind_memory_to_node(*memory_node);
+
+			if (cpus.empty())
+				return;
+
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (int cpu : cpus)
+				CPU_SET(cpu, &set);
+
+			sched_setaffinity(0, sizeof(set), &set);
+		}
+	};
+#endif
+
+	// pins an already running process. on linux prefer the Affinity initialiser so the child never runs elsewhere
+	bool set_affinity(boost::process::child& process, const std::vector<int>& cpus);
+}
@@ -0,0 +1,298 @@
+#include "encoder_tuning.h"
+#include "common/sha256.h"
+
+using json = nlohmann::json;
+
+namespace {
+	struct PresetSpeed {
+		std::string_view preset;
+		double megapixels_per_thread; // rough single thread throughput, only used to compare against the script
+		int lookahead;                // the encoder's own default for the preset, in frames
+	};
+
+	// slowest first. ballpark numbers for a modern desktop core at 1080p, they only need to be right relative to
+	// each other and within a factor of ~2 overall since the encoder gets headroom anyway
+	const std::array X264_PRESETS = {
+		PresetSpeed{ "veryslow", 2.0, 60 },  PresetSpeed{ "slower", 4.0, 60 },    PresetSpeed{ "slow", 9.0, 50 },
+		PresetSpeed{ "medium", 16.0, 40 },   PresetSpeed{ "fast", 22.0, 30 },     PresetSpeed{ "faster", 28.0, 20 },
+		PresetSpeed{ "veryfast", 40.0, 10 }, PresetSpeed{ "superfast", 55.0, 0 }, PresetSpeed{ "ultrafast", 90.0, 0 },
+	};
+
+	const std::array X265_PRESETS = {
+		PresetSpeed{ "veryslow", 0.4, 40 },  PresetSpeed{ "slower", 0.8, 40 },     PresetSpeed{ "slow", 2.0, 25 },
+		PresetSpeed{ "medium", 4.0, 20 },    PresetSpeed{ "fast", 7.0, 15 },       PresetSpeed{ "faster", 10.0, 15 },
+		PresetSpeed{ "veryfast", 12.0, 15 }, PresetSpeed{ "superfast", 18.0, 10 }, PresetSpeed{ "ultrafast", 25.0, 5 },
+	};
+
+	// encoder should be able to run this much faster than the script so it never stalls it
+	const double HEADROOM = 1.25;
+
+	// presets slower than this aren't worth the time even if the encoder would keep up
+	const std::string_view SLOWEST_PRESET = "slow";
+
+	struct Measurement {
+		double fps;
+		int64_t recorded_at; // unix seconds
+	};
+
+	std::mutex measurements_mutex;
+	std::optional<std::unordered_map<std::string, Measurement>> measurements; // loaded on first use
+
+	std::filesystem::path get_cache_path() {
+		return blur.settings_path / encoder_tuning::CACHE_FILENAME;
+	}
+
+	// keys contain the whole settings json, only a digest of them is stored
+	std::string hash_key(const std::string& key) {
+		Sha256 hasher;
+		hasher.update(key);
+		return hasher.finish();
+	}
+
+	std::unordered_map<std::string, Measurement> load_measurements() {
+		std::unordered_map<std::string, Measurement> res;
+
+		std::ifstream file(get_cache_path());
+		if (!file)
+			return res;
+
+		try {
+			json j = json::parse(file);
+
+			for (const auto& item : j.items()) {
+				res[item.key()] = Measurement{
+					.fps = item.value().value("fps", 0.0),
+					.recorded_at = item.value().value("recorded_at", int64_t(0)),
+				};
+			}
+		}
+		catch (const std::exception& e) {
+			u::log("Ignoring unreadable encoder tuning cache: {}", e.what());
+			return {};
+		}
+
+		return res;
+	}
+
+	void save_measurements(const std::unordered_map<std::string, Measurement>& to_save) {
+		json j = json::object();
+		for (const auto& [key, measurement] : to_save) {
+			j[key] = {
+				{ "fps", measurement.fps },
+				{ "recorded_at", measurement.recorded_at },
+			};
+		}
+
+		// write then rename so a crash can't leave a half written cache behind
+		auto cache_path = get_cache_path();
+		auto temp_cache_path = cache_path;
+		temp_cache_path += ".tmp";
+
+		{
+			std::ofstream file(temp_cache_path);
+			if (!file)
+				return;
+
+			file << j.dump();
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(temp_cache_path, cache_path, ec);
+		if (ec)
+			u::log("Failed to save encoder tuning cache: {}", ec.message());
+	}
+
+	void prune_measurements(std::unordered_map<std::string, Measurement>& to_prune) {
+		while (to_prune.size() > encoder_tuning::MAX_MEASUREMENTS) {
+			auto oldest = std::ranges::min_element(to_prune, {}, [](const auto& entry) {
+				return entry.second.recorded_at;
+			});
+			to_prune.erase(oldest);
+		}
+	}
+
+	std::vector<std::wstring>::iterator option_insert_position(std::vector<std::wstring>& ffmpeg_args) {
+		auto codec_it = std::ranges::find_if(ffmpeg_args, [](const std::wstring& arg) {
+			return arg == L"-c:v" || arg == L"-codec:v";
+		});
+
+		// new options go after the codec so they apply to the main output
+		return codec_it != ffmpeg_args.end() && std::next(codec_it) != ffmpeg_args.end() ? std::next(codec_it, 2)
+		                                                                                  : ffmpeg_args.end();
+	}
+
+	bool is_x265(const std::vector<std::wstring>& ffmpeg_args) {
+		return encoder_tuning::get_tunable_encoder(ffmpeg_args) == "libx265";
+	}
+
+	void set_option(std::vector<std::wstring>& ffmpeg_args, const std::wstring& option, const std::wstring& value) {
+		auto option_it = std::ranges::find(ffmpeg_args, option);
+		if (option_it != ffmpeg_args.end() && std::next(option_it) != ffmpeg_args.end())
+			*std::next(option_it) = value;
+		else
+			ffmpeg_args.insert(option_insert_position(ffmpeg_args), { option, value });
+	}
+
+	// libx265 ignores most generic options, its settings go through x265-params instead
+	void set_x265_param(std::vector<std::wstring>& ffmpeg_args, const std::wstring& name, const std::wstring& value) {
+		auto param = std::format(L"{}={}", name, value);
+
+		auto params_it = std::ranges::find(ffmpeg_args, L"-x265-params");
+		if (params_it == ffmpeg_args.end() || std::next(params_it) == ffmpeg_args.end()) {
+			ffmpeg_args.insert(option_insert_position(ffmpeg_args), { L"-x265-params", param });
+			return;
+		}
+
+		auto& params = *std::next(params_it);
+
+		// replace an existing value
+		const std::wregex param_regex(std::format(LR"((^|:){}=[^:]*)", name));
+		if (std::regex_search(params, param_regex))
+			params = std::regex_replace(params, param_regex, L"$1" + param);
+		else
+			params += L":" + param;
+	}
+}
+
+void encoder_tuning::record_upstream_fps(const std::string& key, double fps) {
+	std::lock_guard lock(measurements_mutex);
+
+	// reload first so measurements saved by other blur processes since startup aren't lost
+	measurements = load_measurements();
+
+	(*measurements)[hash_key(key)] = Measurement{
+		.fps = fps,
+		.recorded_at =
+			std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+				.count(),
+	};
+
+	prune_measurements(*measurements);
+	save_measurements(*measurements);
+}
+
+std::optional<double> encoder_tuning::get_upstream_fps(const std::string& key) {
+	std::lock_guard lock(measurements_mutex);
+
+	if (!measurements)
+		measurements = load_measurements();
+
+	auto it = measurements->find(hash_key(key));
+	if (it == measurements->end() || it->second.fps <= 0.0)
+		return {};
+
+	return it->second.fps;
+}
+
+std::string encoder_tuning::Tuning::to_string() const {
+	return std::format(
+		"{} preset {} with {} threads and {} frame lookahead (script at {:.1f} fps{})",
+		encoder,
+		preset,
+		threads,
+		lookahead,
+		upstream_fps,
+		encoder_bound ? ", encoder bound" : ""
+	);
+}
+
+std::optional<std::string> encoder_tuning::get_tunable_encoder(const std::vector<std::wstring>& ffmpeg_args) {
+	for (size_t i = 0; i + 1 < ffmpeg_args.size(); i++) {
+		if (ffmpeg_args[i] != L"-c:v" && ffmpeg_args[i] != L"-codec:v")
+			continue;
+
+		const auto& codec = ffmpeg_args[i + 1];
+		if (codec == L"libx264" || codec == L"libx265")
+			return u::tostring(codec);
+	}
+
+	return {};
+}
+
+std::optional<encoder_tuning::Tuning> encoder_tuning::choose(
+	const std::string& encoder, double upstream_fps, int width, int height, int thread_budget
+) {
+	if (upstream_fps <= 0.0 || width <= 0 || height <= 0)
+		return {};
+
+	thread_budget = std::max(1, thread_budget);
+
+	std::span<const PresetSpeed> presets;
+	if (encoder == "libx264")
+		presets = X264_PRESETS;
+	else if (encoder == "libx265")
+		presets = X265_PRESETS;
+	else
+		return {};
+
+	double required_megapixels = upstream_fps * (width * static_cast<double>(height) / 1'000'000.0) * HEADROOM;
+
+	auto threads_needed = [&](const PresetSpeed& speed) {
+		return std::max(1, static_cast<int>(std::ceil(required_megapixels / speed.megapixels_per_thread)));
+	};
+
+	bool past_slowest = false;
+	for (size_t i = 0; i < presets.size(); i++) {
+		const auto& speed = presets[i];
+
+		past_slowest |= speed.preset == SLOWEST_PRESET;
+		if (!past_slowest)
+			continue;
+
+		int threads = threads_needed(speed);
+		if (threads <= thread_budget) {
+			// lookahead runs alongside the main encode, when half the budget would sit idle it can afford the next
+			// slower preset's lookahead without needing a slower preset overall
+			int lookahead = speed.lookahead;
+			if (i > 0 && threads * 2 <= thread_budget)
+				lookahead = presets[i - 1].lookahead;
+
+			return Tuning{
+				.encoder = encoder,
+				.preset = std::string(speed.preset),
+				.threads = threads,
+				.lookahead = lookahead,
+				.upstream_fps = upstream_fps,
+				.encoder_bound = false,
+			};
+		}
+	}
+
+	// nothing keeps up, use the fastest preset with every thread we can spare
+	return Tuning{
+		.encoder = encoder,
+		.preset = std::string(presets.back().preset),
+		.threads = thread_budget,
+		.lookahead = presets.back().lookahead,
+		.upstream_fps = upstream_fps,
+		.encoder_bound = true,
+	};
+}
+
+void encoder_tuning::set_threads(std::vector<std::wstring>& ffmpeg_args, int threads) {
+	// libx265 ignores -threads, its thread pool size is set through x265-params instead
+	if (is_x265(ffmpeg_args))
+		set_x265_param(ffmpeg_args, L"pools", std::to_wstring(threads));
+	else
+		set_option(ffmpeg_args, L"-threads", std::to_wstring(threads));
+}
+
+void encoder_tuning::set_lookahead(std::vector<std::wstring>& ffmpeg_args, int frames) {
+	if (is_x265(ffmpeg_args))
+		set_x265_param(ffmpeg_args, L"rc-lookahead", std::to_wstring(frames));
+	else
+		set_option(ffmpeg_args, L"-rc-lookahead", std::to_wstring(frames));
+}
+
+bool encoder_tuning::apply(std::vector<std::wstring>& ffmpeg_args, const Tuning& tuning) {
+	auto preset_it = std::ranges::find(ffmpeg_args, L"-preset");
+	if (preset_it == ffmpeg_args.end() || std::next(preset_it) == ffmpeg_args.end())
+		return false;
+
+	*std::next(preset_it) = u::towstring(tuning.preset);
+
+	set_threads(ffmpeg_args, tuning.threads);
+	set_lookahead(ffmpeg_args, tuning.lookahead);
+
+	return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// picks a cpu encoder preset and thread count that keeps up with how fast the vapoursynth script produces frames.
+// when the script is the bottleneck the encoder can afford a slower preset (smaller files), when it isn't the
+// encoder gets more threads. the script's speed is sampled from the progress of real renders, so it's measured while
+// competing with the encoder, and later renders of the same script are tuned from it. measurements are kept in the
+// settings folder so they carry over between runs and between the cli and the gui
+namespace encoder_tuning {
+	// renders shorter than this don't give a useful measurement
+	inline const std::chrono::seconds SAMPLE_DURATION(5);
+
+	const std::string CACHE_FILENAME = "encoder_tuning.json";
+
+	// oldest measurements are dropped past this so the file doesn't grow forever
+	const size_t MAX_MEASUREMENTS = 100;
+
+	struct Tuning {
+		std::string encoder;
+		std::string preset;
+		int threads;
+		int lookahead; // frames
+		double upstream_fps;
+		bool encoder_bound; // even the fastest preset can't keep up with the script
+
+		[[nodiscard]] std::string to_string() const;
+	};
+
+	// key identifies the script's workload (settings and source format)
+	void record_upstream_fps(const std::string& key, double fps);
+	std::optional<double> get_upstream_fps(const std::string& key);
+
+	// name of the encoder used by the given ffmpeg args if it's one we can tune
+	std::optional<std::string> get_tunable_encoder(const std::vector<std::wstring>& ffmpeg_args);
+
+	// thread_budget is the most threads the encoder is allowed to use
+	std::optional<Tuning> choose(
+		const std::string& encoder, double upstream_fps, int width, int height, int thread_budget
+	);
+
+	// sets the encoder thread count, replacing any existing one
+	void set_threads(std::vector<std::wstring>& ffmpeg_args, int threads);
+
+	// sets the encoder's rate control lookahead, replacing any existing one
+	void set_lookahead(std::vector<std::wstring>& ffmpeg_args, int frames);
+
+	// replaces the preset in the ffmpeg args and sets the thread count and lookahead. returns false if there was no
+	// preset to replace
+	bool apply(std::vector<std::wstring>& ffmpeg_args, const Tuning& tuning);
+}
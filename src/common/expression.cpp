@@ -0,0 +1,453 @@
+#include "expression.h"
+
+namespace {
+	using expression::Instruction;
+	using Op = Instruction::Op;
+
+	struct Function1 {
+		std::string_view name;
+		double (*fn)(double);
+	};
+
+	struct Function2 {
+		std::string_view name;
+		double (*fn)(double, double);
+	};
+
+	const std::array FUNCTIONS_1 = {
+		Function1{ "abs", [](double v) { return std::abs(v); } },
+		Function1{ "fabs", [](double v) { return std::abs(v); } },
+		Function1{ "exp", [](double v) { return std::exp(v); } },
+		Function1{ "log", [](double v) { return std::log(v); } },
+		Function1{ "log2", [](double v) { return std::log2(v); } },
+		Function1{ "log10", [](double v) { return std::log10(v); } },
+		Function1{ "sqrt", [](double v) { return std::sqrt(v); } },
+		Function1{ "sin", [](double v) { return std::sin(v); } },
+		Function1{ "cos", [](double v) { return std::cos(v); } },
+		Function1{ "tan", [](double v) { return std::tan(v); } },
+		Function1{ "asin", [](double v) { return std::asin(v); } },
+		Function1{ "acos", [](double v) { return std::acos(v); } },
+		Function1{ "atan", [](double v) { return std::atan(v); } },
+		Function1{ "sinh", [](double v) { return std::sinh(v); } },
+		Function1{ "cosh", [](double v) { return std::cosh(v); } },
+		Function1{ "tanh", [](double v) { return std::tanh(v); } },
+		Function1{ "floor", [](double v) { return std::floor(v); } },
+		Function1{ "ceil", [](double v) { return std::ceil(v); } },
+		Function1{ "round", [](double v) { return std::round(v); } },
+	};
+
+	const std::array FUNCTIONS_2 = {
+		Function2{ "pow", [](double a, double b) { return std::pow(a, b); } },
+		Function2{ "min", [](double a, double b) { return std::min(a, b); } },
+		Function2{ "max", [](double a, double b) { return std::max(a, b); } },
+		Function2{ "atan2", [](double a, double b) { return std::atan2(a, b); } },
+		Function2{ "fmod", [](double a, double b) { return std::fmod(a, b); } },
+	};
+
+	const std::array<std::pair<std::string_view, double>, 3> CONSTANTS = { {
+		{ "pi", std::numbers::pi },
+		{ "e", std::numbers::e },
+		{ "tau", 2 * std::numbers::pi },
+	} };
+
+	// recursive descent parser emitting instructions in postfix order. precedence (low to high):
+	// + -, * / %, unary -, ** (right associative)
+	class Parser {
+	public:
+		explicit Parser(std::string_view source) : m_source(source) {}
+
+		bool parse() {
+			skip_whitespace();
+
+			if (m_pos == m_source.size())
+				return fail("Expression is empty");
+
+			if (!parse_sum())
+				return false;
+
+			skip_whitespace();
+
+			if (m_pos != m_source.size())
+				return fail(std::format("Unexpected '{}' at position {}", m_source[m_pos], m_pos + 1));
+
+			return true;
+		}
+
+		std::vector<Instruction> instructions;
+		size_t max_depth = 0;
+		std::string error;
+
+	private:
+		std::string_view m_source;
+		size_t m_pos = 0;
+		size_t m_depth = 0;
+
+		bool fail(std::string message) {
+			if (error.empty())
+				error = std::move(message);
+
+			return false;
+		}
+
+		void emit(Instruction instruction) {
+			switch (instruction.op) {
+				case Op::CONSTANT:
+				case Op::VARIABLE:
+					m_depth++;
+					max_depth = std::max(max_depth, m_depth);
+					break;
+				case Op::NEGATE:
+				case Op::CALL1:
+					break;
+				default: // binary
+					m_depth--;
+					break;
+			}
+
+			instructions.push_back(instruction);
+		}
+
+		void skip_whitespace() {
+			while (m_pos < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_pos])))
+				m_pos++;
+		}
+
+		bool match(std::string_view token) {
+			skip_whitespace();
+
+			if (m_source.substr(m_pos).starts_with(token)) {
+				m_pos += token.size();
+				return true;
+			}
+
+			return false;
+		}
+
+		bool parse_sum() {
+			if (!parse_product())
+				return false;
+
+			while (true) {
+				if (match("+")) {
+					if (!parse_product())
+						return false;
+					emit({ .op = Op::ADD });
+				}
+				else if (match("-")) {
+					if (!parse_product())
+						return false;
+					emit({ .op = Op::SUBTRACT });
+				}
+				else {
+					return true;
+				}
+			}
+		}
+
+		bool parse_product() {
+			if (!parse_unary())
+				return false;
+
+			while (true) {
+				skip_whitespace();
+
+				// make sure ** isn't read as multiplication
+				if (m_source.substr(m_pos).starts_with("**"))
+					return true;
+
+				if (match("*")) {
+					if (!parse_unary())
+						return false;
+					emit({ .op = Op::MULTIPLY });
+				}
+				else if (match("/")) {
+					if (!parse_unary())
+						return false;
+					emit({ .op = Op::DIVIDE });
+				}
+				else if (match("%")) {
+					if (!parse_unary())
+						return false;
+					emit({ .op = Op::MODULO });
+				}
+				else {
+					return true;
+				}
+			}
+		}
+
+		bool parse_unary() {
+			if (match("-")) {
+				if (!parse_unary())
+					return false;
+				emit({ .op = Op::NEGATE });
+				return true;
+			}
+
+			if (match("+"))
+				return parse_unary();
+
+			return parse_power();
+		}
+
+		bool parse_power() {
+			if (!parse_primary())
+				return false;
+
+			if (match("^"))
+				return fail("'^' isn't supported, use ** for powers");
+
+			if (match("**")) {
+				// right associative, and binds tighter than unary minus on the left only (-x**2 == -(x**2))
+				if (!parse_unary())
+					return false;
+				emit({ .op = Op::POWER });
+			}
+
+			return true;
+		}
+
+		bool parse_number() {
+			const char* begin = m_source.data() + m_pos;
+			const char* end = m_source.data() + m_source.size();
+
+			double value = 0.0;
+			auto [ptr, ec] = std::from_chars(begin, end, value);
+			if (ec != std::errc())
+				return fail(std::format("Invalid number at position {}", m_pos + 1));
+
+			m_pos += ptr - begin;
+			emit({ .op = Op::CONSTANT, .value = value });
+			return true;
+		}
+
+		bool parse_identifier() {
+			size_t start = m_pos;
+			while (m_pos < m_source.size() &&
+			       (std::isalnum(static_cast<unsigned char>(m_source[m_pos])) || m_source[m_pos] == '_'))
+				m_pos++;
+
+			std::string_view name = m_source.substr(start, m_pos - start);
+
+			// allow python style math.exp etc
+			if (name == "math" && m_pos < m_source.size() && m_source[m_pos] == '.') {
+				m_pos++;
+				return parse_identifier();
+			}
+
+			if (name == "x") {
+				emit({ .op = Op::VARIABLE });
+				return true;
+			}
+
+			for (const auto& [constant_name, value] : CONSTANTS) {
+				if (name == constant_name) {
+					emit({ .op = Op::CONSTANT, .value = value });
+					return true;
+				}
+			}
+
+			if (!match("("))
+				return fail(std::format("Unknown variable '{}'", name));
+
+			int arg_count = 0;
+			if (!match(")")) {
+				do {
+					if (!parse_sum())
+						return false;
+					arg_count++;
+				} while (match(","));
+
+				if (!match(")"))
+					return fail(std::format("Expected ')' after arguments to '{}'", name));
+			}
+
+			for (const auto& function : FUNCTIONS_1) {
+				if (name != function.name)
+					continue;
+
+				if (arg_count != 1)
+					return fail(std::format("'{}' takes 1 argument, got {}", name, arg_count));
+
+				emit({ .op = Op::CALL1, .fn1 = function.fn, .name = function.name });
+				return true;
+			}
+
+			for (const auto& function : FUNCTIONS_2) {
+				if (name != function.name)
+					continue;
+
+				if (arg_count != 2)
+					return fail(std::format("'{}' takes 2 arguments, got {}", name, arg_count));
+
+				emit({ .op = Op::CALL2, .fn2 = function.fn, .name = function.name });
+				return true;
+			}
+
+			return fail(std::format("Unknown function '{}'", name));
+		}
+
+		bool parse_primary() {
+			skip_whitespace();
+
+			if (m_pos == m_source.size())
+				return fail("Unexpected end of expression");
+
+			char c = m_source[m_pos];
+
+			if (c == '(') {
+				m_pos++;
+
+				if (!parse_sum())
+					return false;
+
+				if (!match(")"))
+					return fail(std::format("Expected ')' at position {}", m_pos + 1));
+
+				return true;
+			}
+
+			if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+				return parse_number();
+
+			if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+				return parse_identifier();
+
+			return fail(std::format("Unexpected '{}' at position {}", c, m_pos + 1));
+		}
+	};
+}
+
+double expression::Program::evaluate(double x) const {
+	// small expressions fit on the stack, only allocate for unusually deep ones
+	std::array<double, 32> fixed_stack{};
+	std::vector<double> heap_stack;
+
+	double* stack = fixed_stack.data();
+	if (m_stack_size > fixed_stack.size()) {
+		heap_stack.resize(m_stack_size);
+		stack = heap_stack.data();
+	}
+
+	size_t top = 0;
+
+	for (const auto& instruction : m_instructions) {
+		switch (instruction.op) {
+			case Op::CONSTANT:
+				stack[top++] = instruction.value;
+				break;
+			case Op::VARIABLE:
+				stack[top++] = x;
+				break;
+			case Op::NEGATE:
+				stack[top - 1] = -stack[top - 1];
+				break;
+			case Op::CALL1:
+				stack[top - 1] = instruction.fn1(stack[top - 1]);
+				break;
+			default: {
+				double rhs = stack[--top];
+				double& lhs = stack[top - 1];
+
+				switch (instruction.op) {
+					case Op::ADD:
+						lhs += rhs;
+						break;
+					case Op::SUBTRACT:
+						lhs -= rhs;
+						break;
+					case Op::MULTIPLY:
+						lhs *= rhs;
+						break;
+					case Op::DIVIDE:
+						lhs /= rhs;
+						break;
+					case Op::MODULO:
+						// python modulo takes the sign of the divisor
+						lhs = lhs - (std::floor(lhs / rhs) * rhs);
+						break;
+					case Op::POWER:
+						lhs = std::pow(lhs, rhs);
+						break;
+					case Op::CALL2:
+						lhs = instruction.fn2(lhs, rhs);
+						break;
+					default:
+						break;
+				}
+				break;
+			}
+		}
+	}
+
+	return stack[0];
+}
+
+std::vector<float> expression::Program::evaluate(const std::vector<float>& xs) const {
+	std::vector<float> values(xs.size());
+	std::ranges::transform(xs, values.begin(), [this](float x) {
+		return static_cast<float>(evaluate(x));
+	});
+
+	return values;
+}
+
+nlohmann::json expression::Program::to_json() const {
+	auto json = nlohmann::json::array();
+
+	for (const auto& instruction : m_instructions) {
+		switch (instruction.op) {
+			case Op::CONSTANT:
+				json.push_back(nlohmann::json::array({ "const", instruction.value }));
+				break;
+			case Op::VARIABLE:
+				json.push_back(nlohmann::json::array({ "x" }));
+				break;
+			case Op::ADD:
+				json.push_back(nlohmann::json::array({ "add" }));
+				break;
+			case Op::SUBTRACT:
+				json.push_back(nlohmann::json::array({ "sub" }));
+				break;
+			case Op::MULTIPLY:
+				json.push_back(nlohmann::json::array({ "mul" }));
+				break;
+			case Op::DIVIDE:
+				json.push_back(nlohmann::json::array({ "div" }));
+				break;
+			case Op::MODULO:
+				json.push_back(nlohmann::json::array({ "mod" }));
+				break;
+			case Op::POWER:
+				json.push_back(nlohmann::json::array({ "pow" }));
+				break;
+			case Op::NEGATE:
+				json.push_back(nlohmann::json::array({ "neg" }));
+				break;
+			case Op::CALL1:
+				json.push_back(nlohmann::json::array({ "call1", std::string(instruction.name) }));
+				break;
+			case Op::CALL2:
+				json.push_back(nlohmann::json::array({ "call2", std::string(instruction.name) }));
+				break;
+		}
+	}
+
+	return json;
+}
+
+expression::CompileResult expression::compile(const std::string& source) {
+	Parser parser(source);
+
+	if (!parser.parse()) {
+		return {
+			.success = false,
+			.error_message = parser.error,
+		};
+	}
+
+	return {
+		.success = true,
+		.program = Program(std::move(parser.instructions), parser.max_depth),
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// small compiler for single variable math expressions like "exp(-x**2 / 2)", used for custom blur weighting
+// functions. expressions follow python syntax (** for powers, optional math. prefix) since that's what they used to
+// be evaluated with. ^ is rejected rather than guessing whether it was meant as a power or python's xor
+namespace expression {
+	struct Instruction {
+		enum class Op : uint8_t {
+			CONSTANT,
+			VARIABLE,
+			ADD,
+			SUBTRACT,
+			MULTIPLY,
+			DIVIDE,
+			MODULO,
+			POWER,
+			NEGATE,
+			CALL1,
+			CALL2,
+		};
+
+		Op op;
+		double value = 0.0;
+		double (*fn1)(double) = nullptr;
+		double (*fn2)(double, double) = nullptr;
+		std::string_view name; // function name for calls
+	};
+
+	class Program {
+	public:
+		Program(std::vector<Instruction> instructions, size_t stack_size)
+			: m_instructions(std::move(instructions)), m_stack_size(stack_size) {}
+
+		[[nodiscard]] double evaluate(double x) const;
+		[[nodiscard]] std::vector<float> evaluate(const std::vector<float>& xs) const;
+
+		// postfix form for vapoursynth/blur/expression.py, so the script evaluates exactly what was compiled here
+		// instead of parsing the source itself
+		[[nodiscard]] nlohmann::json to_json() const;
+
+	private:
+		std::vector<Instruction> m_instructions;
+		size_t m_stack_size;
+	};
+
+	struct CompileResult {
+		bool success;
+		std::optional<Program> program;
+		std::string error_message;
+	};
+
+	CompileResult compile(const std::string& source);
+}
@@ -0,0 +1,21 @@
+#include "index_cache.h"
+#include "config_app.h"
+
+std::filesystem::path index_cache::get_path() {
+	auto path = blur.settings_path / DIRECTORY_NAME;
+
+	std::error_code ec;
+	std::filesystem::create_directories(path, ec);
+
+	return path;
+}
+
+void index_cache::prune(uint64_t max_bytes) {
+	// scripts touch indexes when they're used, so the oldest write is the least recently used
+	u::prune_directory(get_path(), max_bytes);
+}
+
+void index_cache::prune() {
+	auto app_config = config_app::get_app_config();
+	prune(static_cast<uint64_t>(std::max(app_config.index_cache_size, 0)) * 1024 * 1024);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// on-disk cache of the frame indexes bestsource/l-smash build when opening a video. the vapoursynth script names the
+// index files (keyed on the video's path, size, mtime and the source plugin version) and touches them when they're
+// used, this side owns the directory and keeps it under the size limit by evicting the least recently used ones
+namespace index_cache {
+	const std::string DIRECTORY_NAME = "index_cache";
+
+	std::filesystem::path get_path();
+
+	void prune(uint64_t max_bytes);
+	void prune(); // uses the size limit from the app config
+}
@@ -1,54 +1,129 @@
 ﻿#include "rendering.h"
 #include "config_presets.h"
+#include "weighting.h"
+#include "index_cache.h"
 
-void Rendering::render_videos() {
-	if (!m_queue.empty()) {
-		auto& render = m_queue.front();
-		auto* render_ptr = render.get();
+namespace {
+	// vspipe -p progress lines, e.g. "Frame: 120/3600 (24.51 fps)"
+	std::optional<std::pair<int, int>> parse_progress_line(const std::string& line) {
+		static std::regex frame_regex(R"(Frame: (\d+)\/(\d+)(?: \((\d+\.\d+) fps\))?)");
 
-		lock();
-		{
-			m_current_render_id = render->get_render_id();
-		}
-		unlock();
+		std::smatch match;
+		if (!std::regex_match(line, match, frame_regex))
+			return {};
 
-		rendering.call_progress_callback();
+		return std::pair{ std::stoi(match[1]), std::stoi(match[2]) };
+	}
 
-		RenderResult render_result;
-		try {
-			render_result = render->render();
-		}
-		catch (const std::exception& e) {
-			u::log(e.what());
+	boost::process::environment get_vspipe_environment() {
+		boost::process::environment env = boost::this_process::environment();
+
+#if defined(__APPLE__)
+		if (blur.used_installer) {
+			env["PYTHONHOME"] = (blur.resources_path / "python").string();
+			env["PYTHONPATH"] = (blur.resources_path / "python/lib/python3.12/site-packages").string();
 		}
+#endif
 
-		rendering.call_render_finished_callback(
-			render_ptr, render_result
-		); // note: cant do render.get() here cause compiler optimisations break it somehow (So lit)
+		return env;
+	}
 
-		// finished rendering, delete
-		lock();
-		{
-			m_queue.erase(m_queue.begin());
-			m_current_render_id.reset();
-		}
-		unlock();
+	// whether every source audio stream can be copied into the output container without re-encoding
+	bool can_copy_audio(const std::filesystem::path& output_path, const std::vector<std::string>& audio_codecs) {
+		static const std::unordered_map<std::string, std::unordered_set<std::string>> container_codecs = {
+			{ "mp4", { "aac", "mp3", "alac", "flac", "opus", "ac3", "eac3" } },
+			{ "m4v", { "aac", "mp3", "alac", "ac3", "eac3" } },
+			{ "mov", { "aac", "mp3", "alac", "ac3", "eac3", "pcm_s16le", "pcm_s24le" } },
+			{ "webm", { "opus", "vorbis" } },
+		};
 
-		rendering.call_progress_callback();
+		std::string container = u::to_lower(output_path.extension().string());
+		if (container.starts_with("."))
+			container.erase(0, 1);
+
+		// matroska takes anything ffmpeg can demux
+		if (container == "mkv")
+			return true;
+
+		auto it = container_codecs.find(container);
+		if (it == container_codecs.end())
+			return false; // unknown container, play it safe
+
+		return std::ranges::all_of(audio_codecs, [&](const std::string& codec) {
+			return it->second.contains(codec);
+		});
 	}
-	else {
+}
+
+void Rendering::render_videos() {
+	std::shared_ptr<Render> render;
+
+	lock();
+	{
+		if (!m_queue.empty()) {
+			render = m_queue.front();
+			m_current_render = render;
+			publish_snapshot();
+		}
+	}
+	unlock();
+
+	if (!render) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		return;
+	}
+
+	rendering.call_progress_callback();
+
+	RenderResult render_result;
+	try {
+		render_result = render->render();
 	}
+	catch (const std::exception& e) {
+		u::log(e.what());
+	}
+
+	rendering.call_render_finished_callback(render.get(), render_result);
+
+	// finished rendering, remove from the queue. gui keeps it alive through its snapshot for as long as it needs to
+	lock();
+	{
+		m_queue.erase(m_queue.begin());
+		m_current_render.reset();
+		m_last_finished_render = std::move(render);
+		publish_snapshot();
+	}
+	unlock();
+
+	rendering.call_progress_callback();
 }
 
 Render& Rendering::queue_render(Render&& render) {
 	lock();
-	auto& added = *m_queue.emplace_back(std::make_unique<Render>(std::move(render)));
+	auto& added = *m_queue.emplace_back(std::make_shared<Render>(std::move(render)));
+	publish_snapshot();
 	unlock();
 
 	return added;
 }
 
+// called with m_lock held
+void Rendering::publish_snapshot() {
+	auto snapshot = std::make_shared<RenderQueueSnapshot>();
+	snapshot->renders = m_queue;
+	snapshot->current = m_current_render;
+	snapshot->last_finished = m_last_finished_render;
+
+	// m_lock makes this the only writer, so reading the version and storing don't need to be one atomic step
+	snapshot->version = get_snapshot()->version + 1;
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+	m_snapshot.store(std::move(snapshot));
+#else
+	std::atomic_store(&m_snapshot, std::shared_ptr<const RenderQueueSnapshot>(std::move(snapshot)));
+#endif
+}
+
 void Render::build_output_filename() {
 	// build output filename
 	int num = 1;
@@ -157,6 +232,35 @@ RenderCommandsResult Render::build_render_commands() {
 		};
 	}
 
+	// a job that's only placed on a numa node still has vspipe confined to the node, where vapoursynth's default of one
+	// thread per machine cpu would oversubscribe it
+	if (m_apply_core_split)
+		(*settings_json.json)["num_threads"] = m_core_split.vapoursynth_threads;
+	else if (m_core_split.numa_node)
+		(*settings_json.json)["num_threads"] = std::max(1, static_cast<int>(m_core_split.all_cpus().size()));
+
+	// custom functions are only ever parsed here. the script gets the compiled program and evaluates that when it needs
+	// a frame count other than the precomputed one
+	if (auto function = weighting::get_custom_function(m_settings))
+		(*settings_json.json)["weighting_program"] = function->to_json();
+
+	// precompute blur weights. the script checks the frame count matches its own and works them out itself if not
+	// (e.g. interpolation not reaching the target fps)
+	if (m_video_info.fps) {
+		if (auto blended_frames = weighting::get_blended_frames(m_settings, *m_video_info.fps)) {
+			auto weights = weighting::get_weights(m_settings, *blended_frames);
+			if (weights.success) {
+				(*settings_json.json)["weights"] = {
+					{ "frames", *blended_frames },
+					{ "values", weights.weights },
+				};
+			}
+			else {
+				DEBUG_LOG("not precomputing weights: {}", weights.error_message);
+			}
+		}
+	}
+
 	// Build vspipe command
 	commands.vspipe = { L"-p",
 		                L"-c",
@@ -165,6 +269,12 @@ RenderCommandsResult Render::build_render_commands() {
 		                L"video_path=" + path_string,
 		                L"-a",
 		                L"settings=" + u::towstring(settings_json.json->dump()),
+		                L"-a",
+		                L"index_cache_dir=" + index_cache::get_path().wstring(),
+		                L"-a",
+		                L"ffmpeg_path=" + blur.ffmpeg_path.wstring(),
+		                L"-a",
+		                L"ffprobe_path=" + blur.ffprobe_path.wstring(),
 #if defined(__APPLE__)
 		                L"-a",
 		                std::format(L"macos_bundled={}", blur.used_installer ? L"true" : L"false"),
@@ -176,39 +286,18 @@ RenderCommandsResult Render::build_render_commands() {
 		                blur_script_path,
 		                L"-" };
 
-	// Build ffmpeg command
-	commands.ffmpeg = { L"-loglevel",
-		                L"error",
-		                L"-hide_banner",
-		                L"-stats",
-		                L"-y",
-		                L"-i",
-		                L"-", // piped output from video script
-		                L"-fflags",
-		                L"+genpts",
-		                L"-i",
-		                m_video_path.wstring(), // original video (for audio)
-		                L"-map",
-		                L"0:v",
-		                L"-map",
-		                L"1:a?" };
-
-	if (m_video_info.color_range && *m_video_info.color_range == "pc") {
-		// https://github.com/f0e/blur/issues/106#issuecomment-2783791187
-		commands.ffmpeg.emplace_back(L"-vf");
-		commands.ffmpeg.emplace_back(L"scale=in_range=full:out_range=limited");
-	}
-
 	// Handle audio filters
 	std::vector<std::wstring> audio_filters;
 	if (m_settings.timescale) {
+		int sample_rate = m_video_info.audio_sample_rate.value_or(48000);
+
 		if (m_settings.input_timescale != 1.f) {
-			audio_filters.push_back(std::format(L"asetrate=48000*{}", (1 / m_settings.input_timescale)));
+			audio_filters.push_back(std::format(L"asetrate={}*{}", sample_rate, (1 / m_settings.input_timescale)));
 		}
 
 		if (m_settings.output_timescale != 1.f) {
 			if (m_settings.output_timescale_audio_pitch) {
-				audio_filters.push_back(std::format(L"asetrate=48000*{}", m_settings.output_timescale));
+				audio_filters.push_back(std::format(L"asetrate={}*{}", sample_rate, m_settings.output_timescale));
 			}
 			else {
 				audio_filters.push_back(std::format(L"atempo={}", m_settings.output_timescale));
@@ -216,16 +305,48 @@ RenderCommandsResult Render::build_render_commands() {
 		}
 	}
 
-	if (!audio_filters.empty()) {
+	std::wstring audio_filter_string = u::join(audio_filters, L",");
+
+	// filtered audio doesn't depend on the video at all, so don't make it wait on the encoder. needs the temp path
+	// for its output, render() creates it when this could apply
+	bool separate_audio = !audio_filters.empty() && !m_video_info.audio_codecs.empty() &&
+	                      m_settings.advanced.ffmpeg_override.empty() && !m_temp_path.empty();
+
+	// Build ffmpeg command
+	commands.ffmpeg = { L"-loglevel",
+		                L"error",
+		                L"-hide_banner",
+		                L"-stats",
+		                L"-y",
+		                L"-i",
+		                L"-" }; // piped output from video script
+
+	if (separate_audio) {
+		commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-map", L"0:v" });
+	}
+	else {
+		commands.ffmpeg.insert(
+			commands.ffmpeg.end(),
+			{ L"-fflags",
+		      L"+genpts",
+		      L"-i",
+		      m_video_path.wstring(), // original video (for audio)
+		      L"-map",
+		      L"0:v",
+		      L"-map",
+		      L"1:a?" }
+		);
+	}
+
+	if (m_video_info.color_range && *m_video_info.color_range == "pc") {
+		// https://github.com/f0e/blur/issues/106#issuecomment-2783791187
+		commands.ffmpeg.emplace_back(L"-vf");
+		commands.ffmpeg.emplace_back(L"scale=in_range=full:out_range=limited");
+	}
+
+	if (!audio_filters.empty() && !separate_audio) {
 		commands.ffmpeg.emplace_back(L"-af");
-		commands.ffmpeg.push_back(std::accumulate(
-			std::next(audio_filters.begin()),
-			audio_filters.end(),
-			audio_filters[0],
-			[](const std::wstring& a, const std::wstring& b) {
-				return a + L"," + b;
-			}
-		));
+		commands.ffmpeg.push_back(audio_filter_string);
 	}
 
 	if (!m_settings.advanced.ffmpeg_override.empty()) {
@@ -244,15 +365,73 @@ RenderCommandsResult Render::build_render_commands() {
 
 		commands.ffmpeg.insert(commands.ffmpeg.end(), preset_args.begin(), preset_args.end());
 
-		// audio
-		commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-c:a", L"aac", L"-b:a", L"320k" });
+		if (m_apply_core_split)
+			encoder_tuning::set_threads(commands.ffmpeg, m_core_split.encoder_threads);
 
-		// extra
-		commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-movflags", L"+faststart" });
+		// audio. copy it as-is when it's untouched and the container can hold it, re-encoding only loses quality
+		if (!separate_audio) {
+			if (!m_video_info.audio_codecs.empty() && audio_filters.empty() &&
+			    can_copy_audio(m_output_path, m_video_info.audio_codecs))
+			{
+				commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-c:a", L"copy" });
+			}
+			else {
+				commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-c:a", L"aac", L"-b:a", L"320k" });
+			}
+		}
+
+		// extra. faststart rewrites the whole file, so with separate audio only the final mux does it
+		if (!separate_audio)
+			commands.ffmpeg.insert(commands.ffmpeg.end(), { L"-movflags", L"+faststart" });
+	}
+
+	if (separate_audio) {
+		// kept in temp so it can never clash with a file of the user's
+		auto video_path = m_temp_path / (L"video" + m_output_path.extension().wstring());
+
+		auto audio_path = m_temp_path / "audio.mka";
+
+		commands.separate_audio = SeparateAudioCommands{
+			.audio = { L"-loglevel",
+		               L"error",
+		               L"-hide_banner",
+		               L"-y",
+		               L"-i",
+		               m_video_path.wstring(),
+		               L"-map",
+		               L"0:a",
+		               L"-af",
+		               audio_filter_string,
+		               L"-c:a",
+		               L"aac",
+		               L"-b:a",
+		               L"320k",
+		               audio_path.wstring() },
+			.mux = { L"-loglevel",
+		             L"error",
+		             L"-hide_banner",
+		             L"-y",
+		             L"-i",
+		             video_path.wstring(),
+		             L"-i",
+		             audio_path.wstring(),
+		             L"-map",
+		             L"0:v",
+		             L"-map",
+		             L"1:a",
+		             L"-c",
+		             L"copy",
+		             L"-movflags",
+		             L"+faststart",
+		             m_output_path.wstring() },
+			.video_path = video_path,
+		};
 	}
 
 	// Output path
-	commands.ffmpeg.push_back(m_output_path.wstring());
+	commands.ffmpeg.push_back(
+		commands.separate_audio ? commands.separate_audio->video_path.wstring() : m_output_path.wstring()
+	);
 
 	// Preview output if needed
 	if (m_settings.preview && blur.using_preview) {
@@ -300,13 +479,70 @@ void Render::update_progress(int current_frame, int total_frames) {
 
 	u::log(m_status.progress_string);
 
+	publish_progress();
+}
+
+void Render::publish_progress() {
+	m_progress.store({
+		.finished = m_status.finished,
+		.init = m_status.init,
+		.current_frame = m_status.current_frame,
+		.total_frames = m_status.total_frames,
+		.fps = m_status.fps,
+	});
+
 	rendering.call_progress_callback();
 }
 
+std::string Render::tuning_key() const {
+	// the script's speed depends on its settings and the source, not on how the output gets encoded
+	auto settings_json = m_settings.to_json();
+	std::string settings = settings_json.json ? settings_json.json->dump() : "";
+
+	return std::format(
+		"{}|{}x{}@{}", settings, m_video_info.width, m_video_info.height, m_video_info.fps.value_or(0.0)
+	);
+}
+
+void Render::record_upstream_fps() {
+	// progress timing starts at the first frame, so script startup isn't counted. the render was competing with the
+	// encoder for cpu the whole time, which is what the tuning has to account for anyway
+	if (!m_status.init || m_status.elapsed_time < encoder_tuning::SAMPLE_DURATION || m_status.fps <= 0.f)
+		return;
+
+	encoder_tuning::record_upstream_fps(tuning_key(), m_status.fps);
+}
+
+std::optional<encoder_tuning::Tuning> Render::tune_encoder(const RenderCommands& render_commands) {
+	auto encoder = encoder_tuning::get_tunable_encoder(render_commands.ffmpeg);
+	if (!encoder)
+		return {};
+
+	// measured on earlier renders of the same script, the first one runs with the preset as is
+	auto upstream_fps = encoder_tuning::get_upstream_fps(tuning_key());
+	if (!upstream_fps) {
+		u::log("Script speed not measured yet, using the preset as is");
+		return {};
+	}
+
+	// the encoder can take up to half of the cpu budget, the split is rebalanced around whatever it picks
+	int thread_budget = std::max(1, (m_core_split.vapoursynth_threads + m_core_split.encoder_threads) / 2);
+
+	auto tuning =
+		encoder_tuning::choose(*encoder, *upstream_fps, m_video_info.width, m_video_info.height, thread_budget);
+	if (!tuning)
+		return {};
+
+	u::log("Encoder tuned: {}", tuning->to_string());
+
+	return tuning;
+}
+
 RenderResult Render::do_render(RenderCommands render_commands) {
 	namespace bp = boost::process;
 
 	m_status = RenderStatus{};
+	publish_progress();
 	std::ostringstream vspipe_stderr_output;
 
 	try {
@@ -319,18 +555,29 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 #endif
 			u::log(L"VSPipe command: {} {}", blur.vspipe_path.wstring(), u::join(render_commands.vspipe, L" "));
 			u::log(L"FFmpeg command: {} {}", blur.ffmpeg_path.wstring(), u::join(render_commands.ffmpeg, L" "));
+			if (render_commands.separate_audio) {
+				u::log(
+					L"Audio command: {} {}",
+					blur.ffmpeg_path.wstring(),
+					u::join(render_commands.separate_audio->audio, L" ")
+				);
+			}
 #ifndef _DEBUG
 		}
 #endif
 
-		bp::environment env = boost::this_process::environment();
+		bp::environment env = get_vspipe_environment();
 
-#if defined(__APPLE__)
-		if (blur.used_installer) {
-			env["PYTHONHOME"] = (blur.resources_path / "python").string();
-			env["PYTHONPATH"] = (blur.resources_path / "python/lib/python3.12/site-packages").string();
+		// optionally keep vspipe and ffmpeg on their own cpus
+		bool pin_cpus = m_settings.advanced.pin_cpu_threads;
+		std::vector<int> vspipe_cpus = pin_cpus ? m_core_split.vapoursynth_cpus : std::vector<int>{};
+		std::vector<int> ffmpeg_cpus = pin_cpus ? m_core_split.encoder_cpus : std::vector<int>{};
+
+		if (m_core_split.numa_node && !pin_cpus) {
+			// not pinned to separate cpus, but both still have to stay on the node
+			vspipe_cpus = m_core_split.all_cpus();
+			ffmpeg_cpus = vspipe_cpus;
 		}
-#endif
 
 		// Launch vspipe process
 		bp::child vspipe_process(
@@ -343,6 +590,9 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 #ifdef _WIN32
 			,
 			bp::windows::create_no_window
+#elif defined(__linux__)
+			,
+			cpu::Affinity(vspipe_cpus, m_core_split.numa_node)
 #endif
 		);
 
@@ -357,9 +607,37 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 #ifdef _WIN32
 			,
 			bp::windows::create_no_window
+#elif defined(__linux__)
+			,
+			cpu::Affinity(ffmpeg_cpus, m_core_split.numa_node)
 #endif
 		);
 
+		// runs alongside the video at its own pace, it's done long before the video in practice
+		std::optional<bp::child> audio_process;
+		if (render_commands.separate_audio) {
+			audio_process.emplace(
+				blur.ffmpeg_path.wstring(),
+				bp::args(render_commands.separate_audio->audio),
+				bp::std_out.null(),
+				io_context
+#ifdef _WIN32
+				,
+				bp::windows::create_no_window
+#elif defined(__linux__)
+				,
+				cpu::Affinity(vspipe_cpus, m_core_split.numa_node) // keeps the encoder's cpus for video
+#endif
+			);
+		}
+
+#ifdef _WIN32
+		if (pin_cpus) {
+			cpu::set_affinity(vspipe_process, vspipe_cpus);
+			cpu::set_affinity(ffmpeg_process, ffmpeg_cpus);
+		}
+#endif
+
 		std::thread progress_thread([&]() {
 			std::string line;
 			std::string progress_line;
@@ -373,15 +651,8 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 				}
 				else if (ch == '\r') {
 					// Handle progress update
-					static std::regex frame_regex(R"(Frame: (\d+)\/(\d+)(?: \((\d+\.\d+) fps\))?)");
-
-					std::smatch match;
-					if (std::regex_match(line, match, frame_regex)) {
-						int current_frame = std::stoi(match[1]);
-						int total_frames = std::stoi(match[2]);
-
-						update_progress(current_frame, total_frames);
-					}
+					if (auto progress = parse_progress_line(line))
+						update_progress(progress->first, progress->second);
 
 					// Don't clear the line for logging purposes
 					progress_line = line;
@@ -401,13 +672,34 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 
 		vspipe_process.detach();
 		ffmpeg_process.detach();
+		if (audio_process)
+			audio_process->detach();
 
 		bool killed = false;
 
-		while (vspipe_process.running() || ffmpeg_process.running()) {
+		RenderReport report;
+
+		auto update_peak_memory = [](std::optional<uint64_t>& peak, bp::child& process) {
+			if (!process.running())
+				return;
+
+			if (auto usage = u::get_peak_memory_usage(process))
+				peak = std::max(peak.value_or(0), *usage);
+		};
+
+		auto audio_running = [&] {
+			return audio_process && audio_process->running();
+		};
+
+		while (vspipe_process.running() || ffmpeg_process.running() || audio_running()) {
+			update_peak_memory(report.vspipe_peak_memory, vspipe_process);
+			update_peak_memory(report.ffmpeg_peak_memory, ffmpeg_process);
+
 			if (m_to_kill) {
 				ffmpeg_process.terminate();
 				vspipe_process.terminate();
+				if (audio_running())
+					audio_process->terminate();
 				u::log("render: killed processes early");
 				killed = true;
 				m_to_kill = false;
@@ -428,14 +720,78 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 		if (killed) {
 			return {
 				.stopped = true,
+				.report = report,
 			};
 		}
 
-		m_status.finished = true;
 		bool success = vspipe_process.exit_code() == 0 && ffmpeg_process.exit_code() == 0;
+
+		std::string error_message = vspipe_stderr_output.str();
+
+		if (success && audio_process) {
+			bool muxed = false;
+
+			if (audio_process->exit_code() != 0) {
+				error_message += "\nFailed to process audio";
+			}
+			else {
+				bp::child mux_process(
+					blur.ffmpeg_path.wstring(),
+					bp::args(render_commands.separate_audio->mux),
+					bp::std_out.null()
+#ifdef _WIN32
+					,
+					bp::windows::create_no_window
+#endif
+				);
+
+				while (mux_process.running()) {
+					if (m_to_kill) {
+						mux_process.terminate();
+						u::log("render: killed processes early");
+						m_to_kill = false;
+
+						return {
+							.stopped = true,
+							.report = report,
+						};
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				}
+
+				muxed = mux_process.exit_code() == 0;
+				if (!muxed)
+					error_message += "\nFailed to mux audio";
+			}
+
+			if (!muxed) {
+				// the video encode is the expensive part, keep it as the output rather than losing it with the temp
+				// folder
+				success = false;
+
+				std::error_code ec;
+				std::filesystem::remove(m_output_path, ec);
+				std::filesystem::rename(render_commands.separate_audio->video_path, m_output_path, ec);
+				if (ec) {
+					// temp may be on another drive
+					ec.clear();
+					std::filesystem::copy_file(render_commands.separate_audio->video_path, m_output_path, ec);
+				}
+
+				if (!ec)
+					error_message += std::format(
+						"\nThe video was saved without audio to '{}'", u::tostring(m_output_path.wstring())
+					);
+			}
+		}
+
+		m_status.finished = true;
 		// Final progress update
 		if (success)
 			update_progress(m_status.total_frames, m_status.total_frames);
+		else
+			publish_progress();
 
 		std::chrono::duration<float> elapsed_time = std::chrono::steady_clock::now() - m_status.start_time;
 		float elapsed_seconds = elapsed_time.count();
@@ -443,7 +799,8 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 
 		return {
 			.success = success,
-			.error_message = vspipe_stderr_output.str(),
+			.error_message = error_message,
+			.report = report,
 		};
 	}
 	catch (const boost::system::system_error& e) {
@@ -457,10 +814,11 @@ RenderResult Render::do_render(RenderCommands render_commands) {
 }
 
 RenderResult Render::render() {
-	if (!blur.initialised)
+	// the first job waits for dependencies to be found rather than startup waiting for them
+	if (const auto& initialisation = blur.wait_for_initialisation(); !initialisation.success)
 		return {
 			.success = false,
-			.error_message = "Blur not initialised",
+			.error_message = initialisation.error_message,
 		};
 
 	u::log(L"Rendering '{}'\n", m_video_name);
@@ -488,6 +846,42 @@ RenderResult Render::render() {
 		}
 	}
 
+	// timescaled audio is rendered separately into the temp folder, see build_render_commands
+	if (m_settings.timescale && !m_video_info.audio_codecs.empty() && m_settings.advanced.ffmpeg_override.empty() &&
+	    m_temp_path.empty())
+		create_temp_path();
+
+	auto available_cpus = cpu::get_available_cpus();
+
+	// keep the whole job on one numa node so frames don't cross the interconnect between vspipe and ffmpeg
+	std::optional<cpu::NumaNode> numa_node;
+	if (m_settings.advanced.numa_placement) {
+		numa_node = cpu::pick_numa_node();
+		if (numa_node)
+			available_cpus = numa_node->cpus;
+	}
+
+	// pinned jobs limited to part of the cpu each claim their own block, otherwise concurrent renders all pin to the
+	// same first few cpus
+	size_t cpu_offset = 0;
+	if (m_settings.advanced.pin_cpu_threads && m_settings.advanced.cpu_threads > 0 &&
+	    m_settings.advanced.cpu_threads < static_cast<int>(available_cpus.size()))
+		cpu_offset = cpu::claim_cpu_offset(
+			m_settings.advanced.cpu_threads, numa_node ? std::optional(numa_node->id) : std::nullopt
+		);
+
+	auto split_cores = [&](std::optional<int> encoder_threads = {}) {
+		m_core_split =
+			cpu::split_cores(available_cpus, m_settings.advanced.cpu_threads, encoder_threads, cpu_offset);
+		if (numa_node)
+			m_core_split.numa_node = numa_node->id;
+	};
+
+	split_cores();
+
+	// vapoursynth and the encoder keep their own defaults unless the user limited or pinned threads
+	m_apply_core_split = m_settings.advanced.cpu_threads > 0 || m_settings.advanced.pin_cpu_threads;
+
 	// render
 	auto render_commands_res = build_render_commands();
 	if (!render_commands_res.success || !render_commands_res.commands) {
@@ -497,7 +891,41 @@ RenderResult Render::render() {
 		};
 	}
 
+	// only cpu presets have anything to tune, and custom ffmpeg settings are left alone
+	std::optional<encoder_tuning::Tuning> tuning;
+	if (m_settings.advanced.auto_tune_encoder && !m_settings.gpu_encoding &&
+	    m_settings.advanced.ffmpeg_override.empty())
+		tuning = tune_encoder(*render_commands_res.commands);
+
+	if (tuning) {
+		// rebuild with the script's thread count adjusted to what the encoder was given
+		split_cores(tuning->threads);
+		m_apply_core_split = true;
+
+		render_commands_res = build_render_commands();
+		if (!render_commands_res.success || !render_commands_res.commands) {
+			return {
+				.success = false,
+				.error_message = render_commands_res.error_message,
+			};
+		}
+
+		encoder_tuning::apply(render_commands_res.commands->ffmpeg, *tuning);
+	}
+
 	auto render_res = do_render(*render_commands_res.commands);
+	render_res.report.encoder_tuning = tuning;
+
+	if (render_res.success && m_settings.advanced.auto_tune_encoder)
+		record_upstream_fps();
+	if (m_apply_core_split)
+		render_res.report.core_split = m_core_split;
+
+	// the render may have added a new index
+	index_cache::prune();
+
+	if (blur.verbose || m_settings.advanced.debug)
+		render_res.report.log();
 
 	if (render_res.stopped) {
 		u::log(L"Stopped render '{}'", m_video_name);
@@ -537,11 +965,27 @@ RenderResult Render::render() {
 }
 
 void Rendering::stop_rendering() {
-	for (auto& render : m_queue) {
+	for (const auto& render : get_snapshot()->renders) {
 		render->stop();
 	}
 }
 
+void RenderReport::log() const {
+	auto log_memory = [](const std::string& name, const std::optional<uint64_t>& bytes) {
+		if (bytes)
+			u::log("{} peak memory: {:.1f} MB", name, *bytes / (1024.0 * 1024.0));
+	};
+
+	log_memory("vspipe", vspipe_peak_memory);
+	log_memory("ffmpeg", ffmpeg_peak_memory);
+
+	if (encoder_tuning)
+		u::log("encoder tuning: {}", encoder_tuning->to_string());
+
+	if (core_split)
+		u::log("core split: {}", core_split->to_string());
+}
+
 void RenderStatus::update_progress_string(bool first) {
 	float progress = current_frame / (float)total_frames;
 
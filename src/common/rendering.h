@@ -1,10 +1,20 @@
 #pragma once
 
 #include "config_blur.h"
+#include "encoder_tuning.h"
+#include "cpu.h"
+
+// timescaled audio is filtered by its own ffmpeg while the video renders, then muxed in once both are done
+struct SeparateAudioCommands {
+	std::vector<std::wstring> audio;
+	std::vector<std::wstring> mux;
+	std::filesystem::path video_path; // video-only output of the main ffmpeg, in the temp folder
+};
 
 struct RenderCommands {
 	std::vector<std::wstring> vspipe;
 	std::vector<std::wstring> ffmpeg;
+	std::optional<SeparateAudioCommands> separate_audio;
 };
 
 struct RenderCommandsResult {
@@ -13,12 +23,33 @@ struct RenderCommandsResult {
 	std::optional<RenderCommands> commands;
 };
 
+struct RenderReport {
+	std::optional<uint64_t> vspipe_peak_memory;
+	std::optional<uint64_t> ffmpeg_peak_memory;
+	std::optional<encoder_tuning::Tuning> encoder_tuning;
+	std::optional<cpu::CoreSplit> core_split;
+
+	void log() const;
+};
+
 struct RenderResult {
 	bool success;
 	std::string error_message;
 	bool stopped;
+	RenderReport report;
+};
+
+// what other threads (the gui) see of a render's status. published through a seqlock on every progress update, so it
+// has to stay trivially copyable
+struct RenderProgress {
+	bool finished = false;
+	bool init = false;
+	int current_frame = 0;
+	int total_frames = 0;
+	float fps = 0.f;
 };
 
+// only touched by the render thread
 struct RenderStatus {
 	bool finished = false;
 	bool init = false;
@@ -37,6 +68,7 @@ private:
 	uint32_t m_render_id;
 
 	RenderStatus m_status;
+	u::SeqLock<RenderProgress> m_progress;
 
 	std::wstring m_video_name;
 
@@ -51,6 +83,9 @@ private:
 
 	BlurSettings m_settings;
 
+	cpu::CoreSplit m_core_split;
+	bool m_apply_core_split = false; // only passed on to vapoursynth and the encoder when opted into
+
 	bool m_to_kill = false;
 
 	void build_output_filename();
@@ -58,6 +93,11 @@ private:
 	RenderCommandsResult build_render_commands();
 
 	void update_progress(int current_frame, int total_frames);
+	void publish_progress();
+
+	[[nodiscard]] std::string tuning_key() const;
+	void record_upstream_fps();
+	std::optional<encoder_tuning::Tuning> tune_encoder(const RenderCommands& render_commands);
 
 	RenderResult do_render(RenderCommands render_commands);
 
@@ -90,6 +130,14 @@ public:
 		return m_video_name;
 	}
 
+	[[nodiscard]] std::filesystem::path get_video_path() const {
+		return m_video_path;
+	}
+
+	[[nodiscard]] const u::VideoInfo& get_video_info() const {
+		return m_video_info;
+	}
+
 	[[nodiscard]] std::filesystem::path get_output_video_path() const {
 		return m_output_path;
 	}
@@ -98,8 +146,9 @@ public:
 		return m_settings;
 	}
 
-	[[nodiscard]] RenderStatus get_status() const {
-		return m_status;
+	// safe to call from any thread
+	[[nodiscard]] RenderProgress get_progress() const {
+		return m_progress.load();
 	}
 
 	[[nodiscard]] std::filesystem::path get_preview_path() const {
@@ -107,17 +156,37 @@ public:
 	}
 };
 
+// immutable view of the queue. a new one is published whenever the queue changes, readers keep whichever one they
+// grabbed alive for as long as they need it
+struct RenderQueueSnapshot {
+	uint64_t version = 0;
+	std::vector<std::shared_ptr<Render>> renders;
+	std::shared_ptr<Render> current;
+	std::shared_ptr<Render> last_finished; // the most recent render to leave the queue
+};
+
 class Rendering {
 private:
 	std::unique_ptr<std::thread> m_thread_ptr;
-	std::vector<std::unique_ptr<Render>> m_queue;
-	std::optional<uint32_t> m_current_render_id;
+	std::vector<std::shared_ptr<Render>> m_queue;
+	std::shared_ptr<Render> m_current_render;
+	std::shared_ptr<Render> m_last_finished_render;
+
+	// swapped atomically so readers never wait on the render thread. libc++ doesn't have atomic<shared_ptr> yet, the
+	// atomic_load/atomic_store overloads do the same there
+#if defined(__cpp_lib_atomic_shared_ptr)
+	std::atomic<std::shared_ptr<const RenderQueueSnapshot>> m_snapshot{ std::make_shared<const RenderQueueSnapshot>() };
+#else
+	std::shared_ptr<const RenderQueueSnapshot> m_snapshot = std::make_shared<const RenderQueueSnapshot>();
+#endif
 
 	std::optional<std::function<void()>> m_progress_callback;
 	std::optional<std::function<void(Render*, RenderResult)>> m_render_finished_callback;
 
 	std::mutex m_lock;
 
+	void publish_snapshot();
+
 public:
 	void render_videos();
 
@@ -125,21 +194,17 @@ public:
 
 	void stop_rendering();
 
-	const std::vector<std::unique_ptr<Render>>& get_queue() {
-		return m_queue;
-	}
-
-	std::optional<Render*> get_current_render() {
-		for (const auto& render : m_queue) {
-			if (render->get_render_id() == m_current_render_id)
-				return { render.get() };
-		}
-
-		return {};
+	// never blocks on the render thread
+	[[nodiscard]] std::shared_ptr<const RenderQueueSnapshot> get_snapshot() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+		return m_snapshot.load();
+#else
+		return std::atomic_load(&m_snapshot);
+#endif
 	}
 
-	std::optional<uint32_t> get_current_render_id() {
-		return m_current_render_id;
+	[[nodiscard]] std::shared_ptr<Render> get_current_render() const {
+		return get_snapshot()->current;
 	}
 
 	void set_progress_callback(std::function<void()>&& callback) {
@@ -1,4 +1,5 @@
 ﻿#include "rendering_frame.h"
+#include "index_cache.h"
 
 RenderCommandsResult FrameRender::build_render_commands(
 	const std::filesystem::path& input_path, const std::filesystem::path& output_path, const BlurSettings& settings
@@ -26,6 +27,12 @@ RenderCommandsResult FrameRender::build_render_commands(
 		                L"video_path=" + path_string,
 		                L"-a",
 		                L"settings=" + u::towstring(settings_json.json->dump()),
+		                L"-a",
+		                L"index_cache_dir=" + index_cache::get_path().wstring(),
+		                L"-a",
+		                L"ffmpeg_path=" + blur.ffmpeg_path.wstring(),
+		                L"-a",
+		                L"ffprobe_path=" + blur.ffprobe_path.wstring(),
 #if defined(__APPLE__)
 		                L"-a",
 		                std::format(L"macos_bundled={}", blur.used_installer ? L"true" : L"false"),
@@ -189,10 +196,11 @@ bool FrameRender::remove_temp_path() {
 }
 
 FrameRender::RenderResponse FrameRender::render(const std::filesystem::path& input_path, const BlurSettings& settings) {
-	if (!blur.initialised)
+	// the first job waits for dependencies to be found rather than startup waiting for them
+	if (const auto& initialisation = blur.wait_for_initialisation(); !initialisation.success)
 		return {
 			.success = false,
-			.error_message = "Blur not initialised",
+			.error_message = initialisation.error_message,
 		};
 
 	if (!std::filesystem::exists(input_path)) {
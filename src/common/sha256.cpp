@@ -0,0 +1,118 @@
+#include "sha256.h"
+
+namespace {
+	constexpr std::array<uint32_t, 64> ROUND_CONSTANTS = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+	};
+
+	constexpr uint32_t rotr(uint32_t value, int bits) {
+		return (value >> bits) | (value << (32 - bits));
+	}
+}
+
+Sha256::Sha256()
+	: m_state{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 } {}
+
+void Sha256::process_block(const uint8_t* block) {
+	std::array<uint32_t, 64> w{};
+
+	for (size_t i = 0; i < 16; i++) {
+		w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[(i * 4) + 1]) << 16) |
+		       (uint32_t(block[(i * 4) + 2]) << 8) | uint32_t(block[(i * 4) + 3]);
+	}
+
+	for (size_t i = 16; i < 64; i++) {
+		uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	auto [a, b, c, d, e, f, g, h] = m_state;
+
+	for (size_t i = 0; i < 64; i++) {
+		uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+		uint32_t ch = (e & f) ^ (~e & g);
+		uint32_t temp1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+		uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+		uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+		uint32_t temp2 = s0 + maj;
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + temp1;
+		d = c;
+		c = b;
+		b = a;
+		a = temp1 + temp2;
+	}
+
+	m_state[0] += a;
+	m_state[1] += b;
+	m_state[2] += c;
+	m_state[3] += d;
+	m_state[4] += e;
+	m_state[5] += f;
+	m_state[6] += g;
+	m_state[7] += h;
+}
+
+void Sha256::update(std::span<const uint8_t> data) {
+	m_total_bytes += data.size();
+
+	size_t offset = 0;
+
+	// top up a partial block first
+	if (m_block_size > 0) {
+		size_t take = std::min(data.size(), m_block.size() - m_block_size);
+		std::memcpy(m_block.data() + m_block_size, data.data(), take);
+		m_block_size += take;
+		offset += take;
+
+		if (m_block_size < m_block.size())
+			return;
+
+		process_block(m_block.data());
+		m_block_size = 0;
+	}
+
+	// whole blocks straight from the input
+	for (; offset + m_block.size() <= data.size(); offset += m_block.size())
+		process_block(data.data() + offset);
+
+	m_block_size = data.size() - offset;
+	std::memcpy(m_block.data(), data.data() + offset, m_block_size);
+}
+
+void Sha256::update(std::string_view data) {
+	update(std::span(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+std::string Sha256::finish() {
+	uint64_t total_bits = m_total_bytes * 8;
+
+	// 0x80 then zeros up to 56 mod 64, then the length in bits big endian
+	std::array<uint8_t, 72> padding{};
+	padding[0] = 0x80;
+
+	size_t padding_size = (m_block_size < 56 ? 56 : 120) - m_block_size;
+	for (size_t i = 0; i < 8; i++)
+		padding[padding_size + i] = uint8_t(total_bits >> (56 - (i * 8)));
+
+	update(std::span(padding.data(), padding_size + 8));
+
+	std::string hex;
+	hex.reserve(64);
+
+	for (uint32_t word : m_state)
+		hex += std::format("{:08x}", word);
+
+	return hex;
+}
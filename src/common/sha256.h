@@ -0,0 +1,21 @@
+#pragma once
+
+// incremental sha-256, so data can be hashed as it streams past instead of being read back afterwards
+class Sha256 {
+public:
+	Sha256();
+
+	void update(std::span<const uint8_t> data);
+	void update(std::string_view data);
+
+	// lowercase hex. the hasher can't be updated afterwards
+	std::string finish();
+
+private:
+	std::array<uint32_t, 8> m_state;
+	std::array<uint8_t, 64> m_block{};
+	size_t m_block_size = 0;
+	uint64_t m_total_bytes = 0;
+
+	void process_block(const uint8_t* block);
+};
@@ -0,0 +1,25 @@
+#include "startup.h"
+
+namespace {
+	const auto process_start = std::chrono::steady_clock::now();
+}
+
+bool startup::tracing() {
+	static const bool enabled = [] {
+		const char* env = std::getenv("BLUR_STARTUP_TRACE");
+		return env && std::string_view(env) != "0";
+	}();
+
+	return enabled;
+}
+
+void startup::trace(std::string_view event) {
+	if (!tracing())
+		return;
+
+	u::log(
+		"[startup +{:.1f}ms] {}",
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - process_start).count(),
+		event
+	);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+// startup work that isn't needed for the first frame/render runs as background tasks. a task can wait on the tasks
+// it depends on, and whatever first needs a result waits on it then rather than everything waiting up front
+namespace startup {
+	// BLUR_STARTUP_TRACE=1 logs when each task starts, finishes and gets waited on, relative to process start
+	bool tracing();
+	void trace(std::string_view event);
+
+	template <typename T>
+	class Task {
+	public:
+		Task() = default;
+
+		Task(std::string name, std::function<T()>&& fn) : m_name(std::move(name)) {
+			std::packaged_task<T()> task([name = m_name, fn = std::move(fn)] {
+				trace(std::format("{} started", name));
+
+				T res = fn();
+
+				trace(std::format("{} finished", name));
+
+				return res;
+			});
+
+			m_future = task.get_future().share();
+
+			// detached rather than std::async so exiting never has to wait on a slow probe
+			std::thread(std::move(task)).detach();
+		}
+
+		[[nodiscard]] bool started() const {
+			return m_future.valid();
+		}
+
+		[[nodiscard]] bool ready() const {
+			return started() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		// blocks until the task's done
+		const T& get() const {
+			if (tracing() && !ready()) {
+				auto start = std::chrono::steady_clock::now();
+				m_future.wait();
+
+				trace(std::format(
+					"waited {:.1f}ms for {}",
+					std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+					m_name
+				));
+			}
+
+			return m_future.get();
+		}
+
+	private:
+		std::string m_name;
+		std::shared_future<T> m_future;
+	};
+}
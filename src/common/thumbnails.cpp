@@ -0,0 +1,229 @@
+#include "thumbnails.h"
+
+namespace {
+	enum class State : uint8_t {
+		QUEUED,
+		DONE,
+		FAILED
+	};
+
+	struct Entry {
+		State state;
+		std::filesystem::path thumbnail_path;
+	};
+
+	struct Job {
+		std::filesystem::path video_path;
+		std::filesystem::path thumbnail_path;
+		double timestamp;
+	};
+
+	std::mutex mutex;
+	std::condition_variable jobs_condition;
+	std::deque<Job> jobs;
+	std::unordered_map<std::filesystem::path, Entry> entries;
+	std::optional<std::function<void()>> ready_callback;
+	bool workers_started = false;
+
+	std::optional<std::string> get_key(const std::filesystem::path& video_path) {
+		std::error_code ec;
+
+		auto size = std::filesystem::file_size(video_path, ec);
+		if (ec)
+			return {};
+
+		auto last_write_time = std::filesystem::last_write_time(video_path, ec);
+		if (ec)
+			return {};
+
+		auto identity = std::format(
+			"{}|{}|{}x{}",
+			size,
+			last_write_time.time_since_epoch().count(),
+			thumbnails::MAX_WIDTH,
+			thumbnails::MAX_HEIGHT
+		);
+
+		return std::format(
+			"{:016x}{:016x}", std::hash<std::filesystem::path>()(video_path), std::hash<std::string>()(identity)
+		);
+	}
+
+	bool extract_at(const Job& job, const std::filesystem::path& output_path, double timestamp) {
+		namespace bp = boost::process;
+
+		try {
+			// only decode keyframes, seeking lands on the one nearest the timestamp without decoding anything between
+			bp::child c(
+				blur.ffmpeg_path.wstring(),
+				"-loglevel",
+				"error",
+				"-hide_banner",
+				"-threads",
+				"1",
+				"-skip_frame",
+				"nokey",
+				"-ss",
+				std::format("{:.3f}", timestamp),
+				"-i",
+				job.video_path.wstring(),
+				"-an",
+				"-sn",
+				"-frames:v",
+				"1",
+				"-vf",
+				std::format(
+					"scale={}:{}:force_original_aspect_ratio=decrease", thumbnails::MAX_WIDTH, thumbnails::MAX_HEIGHT
+				),
+				"-q:v",
+				"4",
+				"-y",
+				output_path.wstring(),
+				bp::std_out > bp::null,
+				bp::std_err > bp::null
+#ifdef _WIN32
+				,
+				bp::windows::create_no_window
+#endif
+			);
+
+			c.wait();
+
+			std::error_code ec;
+			return c.exit_code() == 0 && std::filesystem::file_size(output_path, ec) > 0 && !ec;
+		}
+		catch (const boost::system::system_error& e) {
+			u::log_error("Failed to extract thumbnail: {}", e.what());
+			return false;
+		}
+	}
+
+	bool extract(const Job& job) {
+		// written under a temporary name so a half-written file is never picked up
+		auto part_path = job.thumbnail_path;
+		part_path.replace_extension(".part.jpg");
+
+		// seeking past the end writes nothing, fall back to the first frame
+		bool success = extract_at(job, part_path, job.timestamp);
+		if (!success && job.timestamp > 0)
+			success = extract_at(job, part_path, 0);
+
+		std::error_code ec;
+		if (success)
+			std::filesystem::rename(part_path, job.thumbnail_path, ec);
+
+		std::filesystem::remove(part_path, ec);
+
+		return success && !ec;
+	}
+
+	void worker() {
+		while (true) {
+			Job job;
+
+			{
+				std::unique_lock lock(mutex);
+				jobs_condition.wait(lock, [] {
+					return !jobs.empty();
+				});
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			bool success = extract(job);
+			DEBUG_LOG("thumbnail for {}: {}", job.video_path.string(), success ? "done" : "failed");
+
+			std::optional<std::function<void()>> callback;
+
+			{
+				std::lock_guard lock(mutex);
+				entries[job.video_path].state = success ? State::DONE : State::FAILED;
+				callback = ready_callback;
+			}
+
+			if (success && callback)
+				(*callback)();
+		}
+	}
+}
+
+std::filesystem::path thumbnails::get_path() {
+	auto path = blur.settings_path / DIRECTORY_NAME;
+
+	std::error_code ec;
+	std::filesystem::create_directories(path, ec);
+
+	return path;
+}
+
+std::optional<std::filesystem::path> thumbnails::request(
+	const std::filesystem::path& video_path, std::optional<double> duration
+) {
+	{
+		std::lock_guard lock(mutex);
+
+		if (auto it = entries.find(video_path); it != entries.end()) {
+			if (it->second.state == State::DONE)
+				return it->second.thumbnail_path;
+
+			return {};
+		}
+	}
+
+	// first request for this video. stat it once, afterwards it's answered from memory
+	auto key = get_key(video_path);
+	if (!key) {
+		std::lock_guard lock(mutex);
+		entries[video_path] = { .state = State::FAILED };
+		return {};
+	}
+
+	auto thumbnail_path = get_path() / (*key + ".jpg");
+
+	std::error_code ec;
+	if (std::filesystem::exists(thumbnail_path, ec)) {
+		// touch it so pruning sees it as recently used
+		std::filesystem::last_write_time(thumbnail_path, std::filesystem::file_time_type::clock::now(), ec);
+
+		std::lock_guard lock(mutex);
+		entries[video_path] = { .state = State::DONE, .thumbnail_path = thumbnail_path };
+		return thumbnail_path;
+	}
+
+	// a bit into the video, the first frame is often black
+	double timestamp = duration ? std::min(*duration * 0.1, 30.0) : 0.0;
+
+	std::lock_guard lock(mutex);
+
+	entries[video_path] = { .state = State::QUEUED, .thumbnail_path = thumbnail_path };
+	jobs.push_back({
+		.video_path = video_path,
+		.thumbnail_path = thumbnail_path,
+		.timestamp = timestamp,
+	});
+
+	if (!workers_started) {
+		workers_started = true;
+
+		std::thread([] {
+			prune();
+		}).detach();
+
+		for (int i = 0; i < WORKER_COUNT; i++)
+			std::thread(worker).detach();
+	}
+
+	jobs_condition.notify_one();
+
+	return {};
+}
+
+void thumbnails::set_ready_callback(std::function<void()>&& callback) {
+	std::lock_guard lock(mutex);
+	ready_callback = std::move(callback);
+}
+
+void thumbnails::prune(uint64_t max_bytes) {
+	u::prune_directory(get_path(), max_bytes);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// small previews of queued videos. a single keyframe is pulled straight out of the source with ffmpeg (no
+// vapoursynth involved), downscaled, and cached on disk keyed on the video's path, size and mtime. extraction runs on
+// a couple of background workers so asking for hundreds of them never blocks the caller
+namespace thumbnails {
+	const std::string DIRECTORY_NAME = "thumbnails";
+
+	const int MAX_WIDTH = 320;
+	const int MAX_HEIGHT = 180;
+	const int WORKER_COUNT = 2;
+	const uint64_t MAX_CACHE_SIZE = 64ull * 1024 * 1024;
+
+	std::filesystem::path get_path();
+
+	// returns the cached thumbnail if it exists, otherwise queues it (once) and returns nothing. failed videos aren't
+	// retried until the next launch
+	std::optional<std::filesystem::path> request(
+		const std::filesystem::path& video_path, std::optional<double> duration = {}
+	);
+
+	// called from a worker thread whenever a requested thumbnail becomes available
+	void set_ready_callback(std::function<void()>&& callback);
+
+	void prune(uint64_t max_bytes = MAX_CACHE_SIZE);
+}
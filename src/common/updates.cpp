@@ -1,4 +1,5 @@
 #include "common/updates.h"
+#include "common/sha256.h"
 #include <boost/process.hpp>
 
 using json = nlohmann::json;
@@ -54,89 +55,502 @@ namespace {
 		       current_subversions; // latest is newer if more subversions. e.g. 2.111 > 2.11. note: yes, this will
 		                            // happen for v2.0 vs v2 or v2.10 vs v2.1, but edge case, idc. will never happen.
 	}
-}
 
-updates::UpdateCheckRes updates::is_latest_version(bool include_beta) {
-	std::string url = include_beta ? "https://api.github.com/repos/f0e/blur/releases"
-	                               : "https://api.github.com/repos/f0e/blur/releases/latest";
+	const auto CONNECT_TIMEOUT = std::chrono::milliseconds(3000);
+	const auto REQUEST_TIMEOUT = std::chrono::milliseconds(10000);
 
-	auto response = cpr::Get(cpr::Url{ url });
+	struct CachedResponse {
+		std::string url;
+		std::string etag;
+		std::string body;
+		int64_t checked_at = 0; // unix seconds, also bumped on failed attempts
+	};
 
-	if (response.status_code != 200) {
-		u::log("Update check failed with status {}", response.status_code);
-		return { .success = false };
+	std::filesystem::path get_cache_path() {
+		return blur.settings_path / updates::CACHE_FILENAME;
 	}
 
-	try {
-		std::string latest_tag;
+	std::optional<CachedResponse> load_cached_response() {
+		std::ifstream file(get_cache_path());
+		if (!file)
+			return {};
 
-		if (include_beta) {
-			json releases = json::parse(response.text);
+		try {
+			json j = json::parse(file);
 
-			if (releases.empty() || !releases.is_array()) {
-				u::log("Update check failed: No releases found");
-				return { .success = false };
-			}
+			return CachedResponse{
+				.url = j.value("url", ""),
+				.etag = j.value("etag", ""),
+				.body = j.value("body", ""),
+				.checked_at = j.value("checked_at", int64_t(0)),
+			};
+		}
+		catch (const std::exception& e) {
+			u::log("Ignoring unreadable update cache: {}", e.what());
+			return {};
+		}
+	}
+
+	void save_cached_response(const CachedResponse& cached) {
+		json j;
+		j["url"] = cached.url;
+		j["etag"] = cached.etag;
+		j["body"] = cached.body;
+		j["checked_at"] = cached.checked_at;
+
+		// write then rename so a crash can't leave a half written cache behind
+		auto cache_path = get_cache_path();
+		auto temp_cache_path = cache_path;
+		temp_cache_path += ".tmp";
+
+		{
+			std::ofstream file(temp_cache_path);
+			if (!file)
+				return;
+
+			file << j.dump();
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(temp_cache_path, cache_path, ec);
+		if (ec)
+			u::log("Failed to save update cache: {}", ec.message());
+	}
+
+	std::optional<std::string> get_url_override(const char* env_name) {
+		const char* env = std::getenv(env_name);
+		if (!env || !*env)
+			return {};
+
+		std::string url = env;
+		while (url.ends_with('/'))
+			url.pop_back();
+
+		return url;
+	}
 
-			// get most recent release (needs to have an installer, might make a release without one temporarily - don't
-			// want anyone updating until i have)
-			for (const auto& release : releases) {
-				std::string release_tag = release["tag_name"];
+	int64_t get_unix_time() {
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+		    .count();
+	}
+
+	// github lists a "sha256:<hex>" digest for each release asset
+	std::string get_installer_sha256(const json& release) {
+#if defined(_WIN32) || defined(__APPLE__)
+#	if defined(_WIN32)
+		const std::string& installer_name = WINDOWS_INSTALLER_NAME;
+#	else
+		const std::string& installer_name = MACOS_INSTALLER_NAME;
+#	endif
+
+		if (!release.contains("assets"))
+			return {};
+
+		for (const auto& asset : release["assets"]) {
+			if (asset.value("name", "") != installer_name)
+				continue;
+
+			std::string digest = asset.value("digest", "");
+			if (digest.starts_with("sha256:"))
+				return u::to_lower(digest.substr(7));
+		}
+#endif
+
+		return {};
+	}
+
+	updates::UpdateCheckRes parse_release_response(const std::string& body, bool include_beta) {
+		try {
+			std::string latest_tag;
+			std::string installer_sha256;
+
+			if (include_beta) {
+				json releases = json::parse(body);
+
+				if (releases.empty() || !releases.is_array()) {
+					u::log("Update check failed: No releases found");
+					return { .success = false };
+				}
+
+				// get most recent release (needs to have an installer, might make a release without one temporarily -
+				// don't want anyone updating until i have)
+				for (const auto& release : releases) {
+					std::string release_tag = release["tag_name"];
 
-				for (const auto& asset : release["assets"]) {
+					for (const auto& asset : release["assets"]) {
 #if defined(_WIN32)
-					if (asset["name"] == WINDOWS_INSTALLER_NAME) {
+						if (asset["name"] == WINDOWS_INSTALLER_NAME) {
 #elif defined(__linux__)
-					// todo when there's an installer
-					{
+						// todo when there's an installer
+						{
 #elif defined(__APPLE__)
-					if (asset["name"] == MACOS_INSTALLER_NAME) {
+						if (asset["name"] == MACOS_INSTALLER_NAME) {
 #endif
-						if (latest_tag.empty() || is_version_newer(latest_tag, release_tag)) {
-							latest_tag = release_tag;
-							break;
+							if (latest_tag.empty() || is_version_newer(latest_tag, release_tag)) {
+								latest_tag = release_tag;
+								installer_sha256 = get_installer_sha256(release);
+								break;
+							}
 						}
 					}
 				}
 			}
-		}
-		else {
-			json release = json::parse(response.text);
+			else {
+				json release = json::parse(body);
 
-			if (release.contains("tag_name")) {
-				latest_tag = release["tag_name"];
+				if (release.contains("tag_name")) {
+					latest_tag = release["tag_name"];
+					installer_sha256 = get_installer_sha256(release);
+				}
+				else {
+					u::log("Update check failed: Release information not found");
+					return { .success = false };
+				}
 			}
-			else {
-				u::log("Update check failed: Release information not found");
-				return { .success = false };
+
+			// remove 'v' prefix if it exists
+			std::string latest_version_number = latest_tag;
+			if (!latest_tag.empty() && latest_tag[0] == 'v') {
+				latest_version_number = latest_tag.substr(1);
 			}
+
+			bool is_latest = !is_version_newer(BLUR_VERSION, latest_version_number);
+
+			return {
+				.success = true,
+				.is_latest = is_latest,
+				.latest_tag = latest_tag,
+				.latest_tag_url = "https://github.com/f0e/blur/releases/" + latest_tag,
+				.installer_sha256 = installer_sha256,
+			};
+		}
+		catch (const std::exception& e) {
+			u::log("Failed to parse latest release JSON: {}", e.what());
+			return {
+				.success = false,
+			};
 		}
+	}
+
+	const size_t DOWNLOAD_BUFFER_SIZE = static_cast<size_t>(1024 * 1024);
+
+	enum class DownloadStatus : uint8_t {
+		SUCCESS,
+		FAILED,
+		RESTART, // the .part file can't be resumed from
+	};
+
+	struct DownloadResult {
+		DownloadStatus status = DownloadStatus::FAILED;
+		std::string sha256;
+	};
+
+	// the etag (or last-modified date) of the response a .part file was started from, so a resume can tell the
+	// server to only send the rest if the file hasn't changed since
+	std::filesystem::path get_validator_path(const std::filesystem::path& part_path) {
+		auto validator_path = part_path;
+		validator_path += ".validator";
+		return validator_path;
+	}
 
-		// remove 'v' prefix if it exists
-		std::string latest_version_number = latest_tag;
-		if (!latest_tag.empty() && latest_tag[0] == 'v') {
-			latest_version_number = latest_tag.substr(1);
+	std::string load_validator(const std::filesystem::path& part_path) {
+		std::ifstream file(get_validator_path(part_path));
+		std::string validator;
+		std::getline(file, validator);
+		return validator;
+	}
+
+	void save_validator(const std::filesystem::path& part_path, const std::string& validator) {
+		auto validator_path = get_validator_path(part_path);
+
+		if (validator.empty()) {
+			// nothing to check a resume against, so it'll start over instead
+			std::error_code ec;
+			std::filesystem::remove(validator_path, ec);
+			return;
 		}
 
-		bool is_latest = !is_version_newer(BLUR_VERSION, latest_version_number);
+		std::ofstream(validator_path) << validator;
+	}
 
-		return {
-			.success = true,
-			.is_latest = is_latest,
-			.latest_tag = latest_tag,
-			.latest_tag_url = "https://github.com/f0e/blur/releases/" + latest_tag,
-		};
+	void remove_part_file(const std::filesystem::path& part_path) {
+		std::error_code ec;
+		std::filesystem::remove(part_path, ec);
+		std::filesystem::remove(get_validator_path(part_path), ec);
 	}
-	catch (const std::exception& e) {
-		u::log("Failed to parse latest release JSON: {}", e.what());
+
+	// streams url onto the end of part_path through a fixed size buffer, hashing everything as it's written
+	DownloadResult download_to_part_file(
+		const std::string& url,
+		const std::filesystem::path& part_path,
+		const std::optional<std::function<void(const std::string&)>>& progress_callback
+	) {
+		uint64_t resume_offset = 0;
+		if (std::filesystem::exists(part_path))
+			resume_offset = std::filesystem::file_size(part_path);
+
+		std::string resume_validator;
+		if (resume_offset > 0) {
+			// without a validator there's no way to know the bytes on disk belong to the same file
+			resume_validator = load_validator(part_path);
+			if (resume_validator.empty())
+				return { .status = DownloadStatus::RESTART };
+		}
+
+		std::vector<char> buffer;
+		buffer.reserve(DOWNLOAD_BUFFER_SIZE);
+
+		Sha256 hasher;
+
+		// what's already on disk is part of the hash as well
+		if (resume_offset > 0) {
+			u::log("Resuming download from {} bytes", resume_offset);
+
+			buffer.resize(DOWNLOAD_BUFFER_SIZE);
+
+			std::ifstream existing(part_path, std::ios::binary);
+			while (existing.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || existing.gcount() > 0)
+				hasher.update(std::string_view(buffer.data(), static_cast<size_t>(existing.gcount())));
+
+			buffer.clear();
+		}
+
+		std::ofstream file(part_path, std::ios::binary | std::ios::app);
+		if (!file) {
+			u::log("Failed to open {} for writing", part_path.string());
+			return {};
+		}
+
+		auto flush = [&] {
+			file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			hasher.update(std::string_view(buffer.data(), buffer.size()));
+			buffer.clear();
+			return bool(file);
+		};
+
+		int64_t status_code = 0;
+		std::optional<uint64_t> content_length;
+		bool started_body = false;
+
+		uint64_t downloaded_bytes = resume_offset;
+		uint64_t total_bytes = 0;
+		float last_reported_progress = 0.f;
+
+		cpr::Session session;
+		session.SetUrl(cpr::Url{ url });
+		session.SetConnectTimeout(cpr::ConnectTimeout{ CONNECT_TIMEOUT });
+
+		// If-Range makes the server send the whole file (200) instead of the rest if it's changed since
+		if (resume_offset > 0) {
+			session.SetHeader(cpr::Header{
+				{ "Range", std::format("bytes={}-", resume_offset) },
+				{ "If-Range", resume_validator },
+			});
+		}
+
+		std::string etag;
+		std::string last_modified;
+		std::optional<uint64_t> content_range_start;
+		bool range_mismatch = false;
+
+		// called for every response's headers including redirects, so start over on each status line
+		session.SetHeaderCallback(cpr::HeaderCallback([&](const std::string_view& header, intptr_t userdata) -> bool {
+			std::string raw_line(header);
+			boost::algorithm::trim(raw_line);
+
+			// names are case insensitive but validator values have to be sent back exactly
+			std::string line = u::to_lower(raw_line);
+			auto get_value = [&](size_t name_length) {
+				std::string value = raw_line.substr(name_length);
+				boost::algorithm::trim(value);
+				return value;
+			};
+
+			auto parse_number = [](std::string_view str) -> std::optional<uint64_t> {
+				uint64_t value = 0;
+				auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+				if (ec != std::errc())
+					return {};
+				return value;
+			};
+
+			if (line.starts_with("http/")) {
+				auto parts = u::split_string(line, " ");
+				status_code = parts.size() > 1 ? static_cast<int64_t>(parse_number(parts[1]).value_or(0)) : 0;
+				content_length.reset();
+				content_range_start.reset();
+				etag.clear();
+				last_modified.clear();
+			}
+			else if (line.starts_with("content-length:")) {
+				content_length = parse_number(get_value(15));
+			}
+			else if (line.starts_with("content-range:")) {
+				// "bytes <start>-<end>/<total>"
+				std::string value = get_value(14);
+				if (value.starts_with("bytes "))
+					content_range_start = parse_number(std::string_view(value).substr(6));
+			}
+			else if (line.starts_with("etag:")) {
+				etag = get_value(5);
+			}
+			else if (line.starts_with("last-modified:")) {
+				last_modified = get_value(14);
+			}
+
+			return true;
+		}));
+
+		session.SetWriteCallback(cpr::WriteCallback([&](const std::string_view& data, intptr_t userdata) -> bool {
+			if (!started_body) {
+				started_body = true;
+
+				if (status_code == 200) {
+					if (resume_offset > 0) {
+						u::log("File changed or server ignored the range request, downloading from the start");
+
+						file.close();
+						file.open(part_path, std::ios::binary | std::ios::trunc);
+						hasher = Sha256();
+						downloaded_bytes = 0;
+					}
+
+					save_validator(part_path, !etag.empty() ? etag : last_modified);
+				}
+				else if (status_code == 206) {
+					// only append if it really continues from the end of what's on disk
+					if (content_range_start != resume_offset) {
+						range_mismatch = true;
+						return false;
+					}
+				}
+				else {
+					return false; // don't write error pages into the installer
+				}
+
+				total_bytes = downloaded_bytes + content_length.value_or(0);
+			}
+
+			size_t offset = 0;
+			while (offset < data.size()) {
+				size_t take = std::min(data.size() - offset, DOWNLOAD_BUFFER_SIZE - buffer.size());
+				buffer.insert(buffer.end(), data.data() + offset, data.data() + offset + take);
+				offset += take;
+
+				if (buffer.size() == DOWNLOAD_BUFFER_SIZE && !flush())
+					return false;
+			}
+
+			downloaded_bytes += data.size();
+
+			if (progress_callback && total_bytes > 0) {
+				float progress = static_cast<float>(downloaded_bytes) / static_cast<float>(total_bytes);
+				if (progress - last_reported_progress >= 0.01f) {
+					(*progress_callback)(std::format("Downloading update: {:.1f}%", progress * 100.f));
+					last_reported_progress = progress;
+				}
+			}
+
+			return true;
+		}));
+
+		auto response = session.Get();
+
+		bool flushed = flush();
+		file.close();
+
+		if (response.status_code == 416 || range_mismatch)
+			return { .status = DownloadStatus::RESTART };
+
+		if (response.error || (response.status_code != 200 && response.status_code != 206)) {
+			if (response.error)
+				u::log("Download failed: {}", response.error.message);
+			else
+				u::log("Download failed with status code: {}", response.status_code);
+
+			return {}; // keep the .part file, next attempt resumes from it
+		}
+
+		if (!flushed) {
+			u::log("Failed to write to {}", part_path.string());
+			return {};
+		}
+
 		return {
-			.success = false,
+			.status = DownloadStatus::SUCCESS,
+			.sha256 = hasher.finish(),
 		};
 	}
 }
 
+std::string updates::get_api_url() {
+	return get_url_override("BLUR_UPDATE_API_URL").value_or(DEFAULT_API_URL);
+}
+
+std::string updates::get_download_url() {
+	return get_url_override("BLUR_UPDATE_DOWNLOAD_URL").value_or(DEFAULT_DOWNLOAD_URL);
+}
+
+updates::UpdateCheckRes updates::is_latest_version(bool include_beta, std::chrono::seconds check_interval) {
+	std::string url = get_api_url() + (include_beta ? "/repos/f0e/blur/releases" : "/repos/f0e/blur/releases/latest");
+
+	auto cached = load_cached_response();
+	if (cached && cached->url != url)
+		cached.reset(); // beta setting or server changed
+
+	int64_t now = get_unix_time();
+
+	if (cached && now - cached->checked_at < check_interval.count()) {
+		u::log("Using cached update check from {}s ago", now - cached->checked_at);
+
+		if (cached->body.empty())
+			return { .success = false }; // last attempt failed, don't retry until the interval's up
+
+		return parse_release_response(cached->body, include_beta);
+	}
+
+	cpr::Header headers;
+	if (cached && !cached->etag.empty() && !cached->body.empty())
+		headers["If-None-Match"] = cached->etag;
+
+	auto response = cpr::Get(
+		cpr::Url{ url },
+		headers,
+		cpr::ConnectTimeout{ CONNECT_TIMEOUT },
+		cpr::Timeout{ REQUEST_TIMEOUT }
+	);
+
+	CachedResponse new_cache = cached.value_or(CachedResponse{ .url = url });
+	new_cache.checked_at = now;
+
+	if (response.status_code == 304) {
+		u::log("Update check: release info unchanged");
+	}
+	else if (response.status_code == 200) {
+		new_cache.body = response.text;
+		new_cache.etag = response.header.contains("ETag") ? response.header["ETag"] : "";
+	}
+	else {
+		if (response.error)
+			u::log("Update check failed: {}", response.error.message);
+		else
+			u::log("Update check failed with status {}", response.status_code);
+
+		// remember the attempt so offline machines aren't held up by it every launch, but keep the last good
+		// response for when it's revalidated
+		save_cached_response(new_cache);
+		return { .success = false };
+	}
+
+	save_cached_response(new_cache);
+
+	return parse_release_response(new_cache.body, include_beta);
+}
+
 bool updates::update_to_tag(
-	const std::string& tag, const std::optional<std::function<void(const std::string&)>>& progress_callback
+	const std::string& tag,
+	const std::optional<std::function<void(const std::string&)>>& progress_callback,
+	const std::string& expected_sha256
 ) {
 	try {
 		u::log("Beginning update to tag: {}", tag);
@@ -155,59 +569,44 @@ bool updates::update_to_tag(
 		return false;
 #endif
 
-		// Create download URL
-		std::string download_url = "https://github.com/f0e/blur/releases/download/" + tag + "/" + installer_filename;
+		std::string download_url = get_download_url() + "/" + tag + "/" + installer_filename;
 
-		// Open file for writing
-		std::ofstream installer_file(installer_path.string(), std::ios::binary);
-		if (!installer_file.is_open()) {
-			u::log("Failed to create installer file at {}", installer_path.string());
-			return false;
-		}
+		// named after the tag so a leftover download of another release is never resumed from
+		auto part_path = installer_path;
+		part_path += std::format(".{}.part", tag);
 
-		// Setup download with progress tracking
-		size_t total_bytes = 0;
-		size_t downloaded_bytes = 0;
-		float last_reported_progress = 0.0f;
+		DownloadResult download;
+		for (int attempt = 0; attempt < 2; attempt++) {
+			download = download_to_part_file(download_url, part_path, progress_callback);
+			if (download.status != DownloadStatus::RESTART)
+				break;
 
-		// Get file size first
-		auto head_response = cpr::Head(cpr::Url{ download_url });
-		if (head_response.status_code == 200 && head_response.header.contains("Content-Length")) {
-			total_bytes = std::stoul(head_response.header["Content-Length"]);
-			u::log("Total download size: {} bytes", total_bytes);
-		}
-		else {
-			u::log("Unable to determine download size");
-			total_bytes = static_cast<size_t>(80 * 1024 * 1024); // Fallback size 80mb
+			u::log("Partial download can't be resumed, starting over");
+			remove_part_file(part_path);
 		}
 
-		// Setup download session
-		cpr::Session session;
-		session.SetUrl(cpr::Url{ download_url });
-		if (progress_callback) {
-			session.SetWriteCallback(cpr::WriteCallback([&](const std::string_view& data, intptr_t userdata) -> bool {
-				downloaded_bytes += data.size();
-				installer_file.write(data.data(), data.size());
+		if (download.status != DownloadStatus::SUCCESS) {
+			if (progress_callback)
+				(*progress_callback)("Update download failed");
 
-				float progress = static_cast<float>(downloaded_bytes) / static_cast<float>(total_bytes);
-				if (progress - last_reported_progress >= 0.01f) {
-					(*progress_callback)(std::format("Downloading update: {:.1f}%", progress * 100.f));
-					last_reported_progress = progress;
-				}
-
-				return true;
-			}));
+			return false;
 		}
 
-		// Execute download
-		auto response = session.Get();
-		installer_file.close();
+		u::log("Downloaded installer sha256: {}", download.sha256);
+
+		if (!expected_sha256.empty() && download.sha256 != expected_sha256) {
+			u::log("Installer hash mismatch, expected {}", expected_sha256);
+			remove_part_file(part_path);
+
+			if (progress_callback)
+				(*progress_callback)("Update download was corrupted, please try again");
 
-		if (response.status_code != 200) {
-			u::log("Download failed with status code: {}", response.status_code);
 			return false;
 		}
 
+		std::filesystem::rename(part_path, installer_path);
+		remove_part_file(part_path);
+
 		// Complete progress
 		if (progress_callback)
 			(*progress_callback)("Update download complete");
@@ -236,5 +635,5 @@ bool updates::update_to_latest(
 		return false;
 	}
 
-	return update_to_tag(check_result.latest_tag, progress_callback);
+	return update_to_tag(check_result.latest_tag, progress_callback, check_result.installer_sha256);
 }
@@ -6,12 +6,29 @@ namespace updates {
 		bool is_latest = true; // assumption for fails
 		std::string latest_tag;
 		std::string latest_tag_url;
+		std::string installer_sha256; // empty if the release doesn't list one
 	};
 
-	UpdateCheckRes is_latest_version(bool include_beta = false);
+	const std::string DEFAULT_API_URL = "https://api.github.com";
+	const std::string DEFAULT_DOWNLOAD_URL = "https://github.com/f0e/blur/releases/download";
+	const std::string CACHE_FILENAME = "update_check.json";
 
+	// BLUR_UPDATE_API_URL and BLUR_UPDATE_DOWNLOAD_URL override the base urls, e.g. to point at a local server when
+	// testing
+	std::string get_api_url();
+	std::string get_download_url();
+
+	// the last response and its etag are cached in the settings folder. within check_interval of the last attempt
+	// the cached response is used without touching the network, after that it's revalidated with If-None-Match
+	UpdateCheckRes is_latest_version(bool include_beta = false, std::chrono::seconds check_interval = {});
+
+	// downloads to a .part file (per tag) next to the installer, picking up where a previous attempt stopped as long as
+	// the server confirms the file hasn't changed. the installer's only launched if it matches expected_sha256 (when
+	// given)
 	bool update_to_tag(
-		const std::string& tag, const std::optional<std::function<void(const std::string&)>>& progress_callback = {}
+		const std::string& tag,
+		const std::optional<std::function<void(const std::string&)>>& progress_callback = {},
+		const std::string& expected_sha256 = ""
 	);
 	bool update_to_latest(
 		bool include_beta = false, const std::optional<std::function<void(const std::string&)>>& progress_callback = {}
@@ -1,5 +1,6 @@
 #include "utils.h"
 #include "common/config_presets.h"
+#include "common/index_cache.h"
 
 std::string u::trim(std::string_view str) {
 	str.remove_prefix(std::min(str.find_first_not_of(" \t\r\v\n"), str.size()));
@@ -245,6 +246,49 @@ std::filesystem::path u::get_settings_path() {
 	return settings_path;
 }
 
+void u::prune_directory(const std::filesystem::path& path, uint64_t max_bytes) {
+	struct CachedFile {
+		std::filesystem::path path;
+		uint64_t size;
+		std::filesystem::file_time_type last_used;
+	};
+
+	std::vector<CachedFile> files;
+	uint64_t total_size = 0;
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+		if (!entry.is_regular_file(ec))
+			continue;
+
+		CachedFile file{
+			.path = entry.path(),
+			.size = entry.file_size(ec),
+			.last_used = entry.last_write_time(ec),
+		};
+
+		total_size += file.size;
+		files.push_back(std::move(file));
+	}
+
+	if (total_size <= max_bytes)
+		return;
+
+	std::ranges::sort(files, {}, &CachedFile::last_used);
+
+	for (const auto& file : files) {
+		if (total_size <= max_bytes)
+			break;
+
+		// might still be open by something on windows, it'll be retried next time
+		if (!std::filesystem::remove(file.path, ec))
+			continue;
+
+		total_size -= file.size;
+		DEBUG_LOG("evicted {}", file.path.string());
+	}
+}
+
 u::VideoInfo u::get_video_info(const std::filesystem::path& path) {
 	namespace bp = boost::process;
 
@@ -254,11 +298,11 @@ u::VideoInfo u::get_video_info(const std::filesystem::path& path) {
 		"-v",
 		"error",
 		"-show_entries",
-		"stream=codec_type,codec_name,duration,color_range",
+		"stream=codec_type,codec_name,duration,color_range,r_frame_rate,width,height,sample_rate",
 		"-show_entries",
 		"format=duration",
 		"-of",
-		"default=noprint_wrappers=1",
+		"json",
 		path.wstring(),
 		bp::std_out > pipe_stream,
 		bp::std_err > bp::null
@@ -268,46 +312,138 @@ u::VideoInfo u::get_video_info(const std::filesystem::path& path) {
 #endif
 	);
 
+	std::string output{ std::istreambuf_iterator<char>(pipe_stream), std::istreambuf_iterator<char>() };
+
+	c.wait();
+
 	VideoInfo info;
 
-	bool has_video_stream = false;
-	double duration = 0.0;
-	std::string codec_name;
+	nlohmann::json probe = nlohmann::json::parse(output, nullptr, false);
+	if (probe.is_discarded() || !probe.is_object())
+		return info;
 
-	std::string line;
-	while (pipe_stream && std::getline(pipe_stream, line)) {
-		boost::algorithm::trim(line);
+	// ffprobe reports most numbers as strings in json output
+	auto get_number = [](const nlohmann::json& object, const char* key) -> std::optional<double> {
+		auto it = object.find(key);
+		if (it == object.end())
+			return {};
 
-		if (line.find("codec_type=video") != std::string::npos) {
-			has_video_stream = true;
-		}
-		else if (line.find("codec_name=") != std::string::npos) {
-			codec_name = line.substr(line.find('=') + 1);
-		}
-		else if (line.find("duration=") != std::string::npos) {
+		if (it->is_number())
+			return it->get<double>();
+
+		if (it->is_string()) {
 			try {
-				duration = std::stod(line.substr(line.find('=') + 1));
+				return std::stod(it->get<std::string>());
 			}
-			catch (...) {
-				duration = 0.0;
+			catch (...) {}
+		}
+
+		return {};
+	};
+
+	auto get_string = [](const nlohmann::json& object, const char* key) -> std::string {
+		auto it = object.find(key);
+		return it != object.end() && it->is_string() ? it->get<std::string>() : "";
+	};
+
+	bool has_video_stream = false;
+	double duration = get_number(probe.value("format", nlohmann::json::object()), "duration").value_or(0.0);
+	std::string codec_name;
+
+	for (const auto& stream : probe.value("streams", nlohmann::json::array())) {
+		std::string codec_type = get_string(stream, "codec_type");
+
+		if (codec_type == "audio") {
+			info.audio_codecs.push_back(get_string(stream, "codec_name"));
+
+			if (!info.audio_sample_rate) {
+				if (auto sample_rate = get_number(stream, "sample_rate"))
+					info.audio_sample_rate = static_cast<int>(*sample_rate);
 			}
+
+			continue;
 		}
-		else if (line.find("color_range=") != std::string::npos) {
-			info.color_range = line.substr(line.find('=') + 1);
+
+		if (codec_type != "video")
+			continue;
+
+		codec_name = get_string(stream, "codec_name");
+
+		if (auto stream_duration = get_number(stream, "duration"))
+			duration = std::max(duration, *stream_duration);
+
+		if (has_video_stream)
+			continue; // first video stream only
+
+		has_video_stream = true;
+
+		info.width = static_cast<int>(get_number(stream, "width").value_or(0));
+		info.height = static_cast<int>(get_number(stream, "height").value_or(0));
+
+		if (auto color_range = get_string(stream, "color_range"); !color_range.empty())
+			info.color_range = color_range;
+
+		// reported as a fraction, e.g. 60000/1001
+		std::string rate = get_string(stream, "r_frame_rate");
+		auto slash = rate.find('/');
+
+		try {
+			double num = std::stod(rate.substr(0, slash));
+			double den = slash != std::string::npos ? std::stod(rate.substr(slash + 1)) : 1.0;
+
+			if (num > 0 && den > 0)
+				info.fps = num / den;
 		}
+		catch (...) {}
 	}
 
-	c.wait();
-
 	// 1. It must have a video stream
 	// 2. Either it has a non-zero duration or it's an animated format
 	// Static images will typically have duration=0 or N/A
 	bool is_animated_format = u::contains(codec_name, "gif") || u::contains(codec_name, "webp");
 	info.has_video_stream = has_video_stream && (duration > 0.1 || is_animated_format);
 
+	if (duration > 0)
+		info.duration = duration;
+
 	return info;
 }
 
+std::optional<uint64_t> u::get_peak_memory_usage(boost::process::child& process) {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (!GetProcessMemoryInfo(process.native_handle(), &counters, sizeof(counters)))
+		return {};
+
+	return counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+	std::ifstream status(std::format("/proc/{}/status", process.id()));
+
+	std::string line;
+	while (std::getline(status, line)) {
+		if (!line.starts_with("VmHWM:"))
+			continue;
+
+		try {
+			return std::stoull(line.substr(6)) * 1024; // reported in kB
+		}
+		catch (...) {
+			return {};
+		}
+	}
+
+	return {};
+#elif defined(__APPLE__)
+	rusage_info_current info{};
+	if (proc_pid_rusage(process.id(), RUSAGE_INFO_CURRENT, reinterpret_cast<rusage_info_t*>(&info)) != 0)
+		return {};
+
+	return info.ri_lifetime_max_phys_footprint;
+#else
+	return {};
+#endif
+}
+
 static bool init_hw = false;
 std::set<std::string> hw_accels;
 std::set<std::string> hw_encoders;
@@ -316,6 +452,9 @@ std::vector<u::EncodingDevice> u::get_hardware_encoding_devices() {
 	namespace bp = boost::process;
 
 	static std::vector<EncodingDevice> devices;
+	static std::mutex mutex; // probed in the background at startup, anything else asking waits for that to finish
+
+	std::lock_guard lock(mutex);
 
 	if (init_hw)
 		return devices;
@@ -484,8 +623,7 @@ std::string u::get_primary_gpu_type() {
 }
 
 std::vector<std::string> u::get_supported_presets(bool gpu_encoding, const std::string& gpu_type) {
-	if (!init_hw)
-		get_hardware_encoding_devices();
+	get_hardware_encoding_devices(); // makes sure hw_encoders is filled in
 
 	auto available_presets = config_presets::get_available_presets(gpu_encoding, gpu_type);
 
@@ -620,6 +758,8 @@ int u::get_fastest_rife_gpu_index(
 			std::format(L"rife_gpu_index={}", gpu_index),
 			L"-a",
 			std::format(L"benchmark_video_path={}", benchmark_video_path.wstring()),
+			L"-a",
+			std::format(L"index_cache_dir={}", index_cache::get_path().wstring()),
 #if defined(__APPLE__)
 			L"-a",
 			std::format(L"macos_bundled={}", blur.used_installer ? L"true" : L"false"),
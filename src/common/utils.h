@@ -118,6 +118,66 @@ namespace u {
 		return result.str();
 	}
 
+	// single writer, any number of readers. readers never block the writer, they retry if a write happened while they
+	// were copying. the value is stored as atomic words so concurrent reads aren't a data race
+	template<typename T>
+	requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+	class SeqLock {
+		static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		std::atomic<uint64_t> m_sequence = 0;
+		std::array<std::atomic<uint64_t>, WORD_COUNT> m_words{};
+
+	public:
+		SeqLock() {
+			store(T{});
+		}
+
+		// copies take a snapshot, they aren't meant to race with writes
+		SeqLock(const SeqLock& other) {
+			store(other.load());
+		}
+
+		SeqLock& operator=(const SeqLock& other) {
+			store(other.load());
+			return *this;
+		}
+
+		void store(const T& value) {
+			std::array<uint64_t, WORD_COUNT> words{};
+			std::memcpy(words.data(), &value, sizeof(T));
+
+			uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+			m_sequence.store(sequence + 1, std::memory_order_relaxed); // odd = write in progress
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for (size_t i = 0; i < WORD_COUNT; i++)
+				m_words[i].store(words[i], std::memory_order_relaxed);
+
+			m_sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		T load() const {
+			std::array<uint64_t, WORD_COUNT> words{};
+			uint64_t before = 0;
+			uint64_t after = 0;
+
+			do {
+				before = m_sequence.load(std::memory_order_acquire);
+
+				for (size_t i = 0; i < WORD_COUNT; i++)
+					words[i] = m_words[i].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				after = m_sequence.load(std::memory_order_relaxed);
+			} while (before != after || (before & 1) != 0);
+
+			T value;
+			std::memcpy(&value, words.data(), sizeof(T));
+			return value;
+		}
+	};
+
 	template<std::ranges::range Container, typename T>
 	requires(!std::same_as<std::remove_cvref_t<Container>, std::string>)
 	bool contains(const Container& container, const T& value) {
@@ -157,13 +217,25 @@ namespace u {
 	std::filesystem::path get_resources_path();
 	std::filesystem::path get_settings_path();
 
+	// deletes the least recently written files in a directory until it's under max_bytes
+	void prune_directory(const std::filesystem::path& path, uint64_t max_bytes);
+
 	struct VideoInfo {
 		bool has_video_stream = false;
 		std::optional<std::string> color_range;
+		std::optional<double> fps;
+		int width = 0;
+		int height = 0;
+		std::optional<double> duration;
+		std::vector<std::string> audio_codecs; // one per audio stream, in stream order
+		std::optional<int> audio_sample_rate;  // of the first audio stream
 	};
 
 	VideoInfo get_video_info(const std::filesystem::path& path);
 
+	// peak resident memory of a running child process in bytes. has to be polled while the process is alive
+	std::optional<uint64_t> get_peak_memory_usage(boost::process::child& process);
+
 	struct EncodingDevice {
 		std::string type;   // "nvidia", "amd", "intel", "mac"
 		std::string method; // Specific encoding method (e.g., "nvenc", "amf", "qsv", "videotoolbox")
@@ -0,0 +1,333 @@
+#include "weighting.h"
+
+namespace {
+	const int VALIDATION_FRAMES = 25;
+
+	std::optional<std::pair<float, float>> parse_bound(const std::string& bound_string) {
+		try {
+			auto bound = nlohmann::json::parse(bound_string);
+			if (!bound.is_array() || bound.size() != 2)
+				return {};
+
+			return std::pair{ bound[0].get<float>(), bound[1].get<float>() };
+		}
+		catch (...) {
+			return {};
+		}
+	}
+
+	std::optional<weighting::Weights> parse_custom_weights(const std::string& weights_string) {
+		try {
+			auto weights = nlohmann::json::parse(weights_string);
+			if (!weights.is_array() || weights.empty())
+				return {};
+
+			return weights.get<weighting::Weights>();
+		}
+		catch (...) {
+			return {};
+		}
+	}
+
+	// same rules as parse_fps_setting in blur.py: "5x" multiplies the current fps, anything else is an absolute fps
+	std::optional<double> parse_fps_setting(const std::string& setting, double current_fps) {
+		std::string value = setting;
+		boost::algorithm::trim(value);
+
+		try {
+			if (value.ends_with('x'))
+				return current_fps * std::stod(value.substr(0, value.size() - 1));
+
+			return std::stoi(value);
+		}
+		catch (...) {
+			return {};
+		}
+	}
+
+	float gaussian_value(float x, float standard_deviation) {
+		return std::exp(-(x * x) / (2 * standard_deviation * standard_deviation));
+	}
+}
+
+weighting::Weights weighting::scale_range(int frames, float a, float b) {
+	if (frames <= 1)
+		return Weights(std::max(frames, 0), a);
+
+	Weights range(frames);
+	for (int x = 0; x < frames; x++)
+		range[x] = (static_cast<float>(x) * (b - a) / static_cast<float>(frames - 1)) + a;
+
+	return range;
+}
+
+weighting::Weights weighting::normalise(Weights weights) {
+	if (weights.empty())
+		return weights;
+
+	// shift negative weights up so they don't cancel out the rest
+	float min = *std::ranges::min_element(weights);
+	if (min < 0.f) {
+		for (auto& weight : weights)
+			weight -= min;
+	}
+
+	float total = std::accumulate(weights.begin(), weights.end(), 0.f);
+	if (total <= 0.f)
+		return equal(static_cast<int>(weights.size()));
+
+	for (auto& weight : weights)
+		weight /= total;
+
+	return weights;
+}
+
+weighting::Weights weighting::equal(int frames) {
+	return Weights(frames, 1.f / static_cast<float>(frames));
+}
+
+weighting::Weights weighting::gaussian(int frames, float standard_deviation, const std::pair<float, float>& bound) {
+	Weights weights = scale_range(frames, bound.first, bound.second);
+	for (auto& weight : weights)
+		weight = gaussian_value(weight, standard_deviation);
+
+	return normalise(std::move(weights));
+}
+
+weighting::Weights weighting::gaussian_sym(int frames, float standard_deviation, const std::pair<float, float>& bound) {
+	float max_abs = std::max(bound.first, bound.second);
+
+	Weights weights = scale_range(frames, -max_abs, max_abs);
+	for (auto& weight : weights)
+		weight = gaussian_value(weight, standard_deviation);
+
+	return normalise(std::move(weights));
+}
+
+weighting::Weights weighting::pyramid(int frames, bool reverse) {
+	Weights weights(frames);
+	for (int x = 0; x < frames; x++)
+		weights[x] = static_cast<float>(reverse ? frames - x : x + 1);
+
+	return normalise(std::move(weights));
+}
+
+weighting::Weights weighting::pyramid_sym(int frames) {
+	float half = static_cast<float>(frames - 1) / 2;
+
+	Weights weights(frames);
+	for (int x = 0; x < frames; x++)
+		weights[x] = half - std::abs(static_cast<float>(x) - half) + 1;
+
+	return normalise(std::move(weights));
+}
+
+// stretch the given weights to a specific length, e.g. frames = 10, weights = [1,2] gives
+// [1, 1, 1, 1, 1, 2, 2, 2, 2, 2] before normalising
+weighting::Weights weighting::custom_weight(int frames, const Weights& weights) {
+	Weights range = scale_range(frames, 0.f, static_cast<float>(weights.size()) - 0.1f);
+
+	Weights stretched(frames);
+	for (int x = 0; x < frames; x++)
+		stretched[x] = weights[static_cast<size_t>(range[x])];
+
+	return normalise(std::move(stretched));
+}
+
+weighting::Weights weighting::custom_function(
+	int frames, const expression::Program& function, const std::pair<float, float>& bound
+) {
+	return normalise(function.evaluate(scale_range(frames, bound.first, bound.second)));
+}
+
+bool weighting::is_custom_weight(const std::string& weighting) {
+	return weighting.starts_with('[') && weighting.ends_with(']');
+}
+
+weighting::ValidateResult weighting::validate(const BlurSettings& settings) {
+	const auto& weighting = settings.blur_weighting;
+
+	if (u::contains(WEIGHTINGS, weighting))
+		return { .success = true };
+
+	if (is_custom_weight(weighting)) {
+		if (!parse_custom_weights(weighting)) {
+			return {
+				.success = false,
+				.error_message = std::format("Custom blur weighting ({}) is not a valid list of numbers", weighting),
+			};
+		}
+
+		return { .success = true };
+	}
+
+	auto function = expression::compile(weighting);
+	if (!function.success) {
+		return {
+			.success = false,
+			.error_message = std::format("Blur weighting function ({}) is invalid: {}", weighting, function.error_message),
+		};
+	}
+
+	// catch functions that compile but can't produce usable weights, e.g. log(x) over a range including 0
+	auto bound = parse_bound(settings.advanced.blur_weighting_bound).value_or(std::pair{ 0.f, 1.f });
+	auto weights = custom_function(VALIDATION_FRAMES, *function.program, bound);
+
+	auto is_finite = [](float weight) {
+		return std::isfinite(weight);
+	};
+
+	if (!std::ranges::all_of(weights, is_finite)) {
+		return {
+			.success = false,
+			.error_message = std::format("Blur weighting function ({}) doesn't produce finite weights", weighting),
+		};
+	}
+
+	return { .success = true };
+}
+
+weighting::WeightsResult weighting::get_weights(const BlurSettings& settings, int frames) {
+	if (frames <= 0) {
+		return {
+			.success = false,
+			.error_message = std::format("Invalid number of blended frames ({})", frames),
+		};
+	}
+
+	const auto& weighting = settings.blur_weighting;
+
+	if (weighting == "equal") {
+		return {
+			.success = true,
+			.weights = equal(frames),
+		};
+	}
+
+	if (weighting == "pyramid") {
+		return {
+			.success = true,
+			.weights = pyramid(frames, settings.advanced.blur_weighting_triangle_reverse),
+		};
+	}
+
+	if (weighting == "pyramid_sym") {
+		return {
+			.success = true,
+			.weights = pyramid_sym(frames),
+		};
+	}
+
+	if (weighting == "gaussian" || weighting == "gaussian_sym") {
+		auto bound = parse_bound(settings.advanced.blur_weighting_bound);
+		if (!bound) {
+			return {
+				.success = false,
+				.error_message =
+					std::format("Blur weighting bound ({}) is not a valid range", settings.advanced.blur_weighting_bound),
+			};
+		}
+
+		float std_dev = settings.advanced.blur_weighting_gaussian_std_dev;
+
+		return {
+			.success = true,
+			.weights = weighting == "gaussian" ? gaussian(frames, std_dev, *bound) : gaussian_sym(frames, std_dev, *bound),
+		};
+	}
+
+	if (is_custom_weight(weighting)) {
+		auto custom_weights = parse_custom_weights(weighting);
+		if (!custom_weights) {
+			return {
+				.success = false,
+				.error_message = std::format("Custom blur weighting ({}) is not a valid list of numbers", weighting),
+			};
+		}
+
+		return {
+			.success = true,
+			.weights = custom_weight(frames, *custom_weights),
+		};
+	}
+
+	if (u::contains(WEIGHTINGS, weighting)) {
+		// placeholder names without an actual weighting filled in
+		return {
+			.success = false,
+			.error_message = std::format("Blur weighting ({}) has no weights or function set", weighting),
+		};
+	}
+
+	auto function = expression::compile(weighting);
+	if (!function.success) {
+		return {
+			.success = false,
+			.error_message = std::format("Blur weighting function ({}) is invalid: {}", weighting, function.error_message),
+		};
+	}
+
+	auto bound = parse_bound(settings.advanced.blur_weighting_bound);
+	if (!bound) {
+		return {
+			.success = false,
+			.error_message =
+				std::format("Blur weighting bound ({}) is not a valid range", settings.advanced.blur_weighting_bound),
+		};
+	}
+
+	return {
+		.success = true,
+		.weights = custom_function(frames, *function.program, *bound),
+	};
+}
+
+std::optional<expression::Program> weighting::get_custom_function(const BlurSettings& settings) {
+	const auto& weighting = settings.blur_weighting;
+	if (u::contains(WEIGHTINGS, weighting) || is_custom_weight(weighting))
+		return {};
+
+	return expression::compile(weighting).program;
+}
+
+std::optional<int> weighting::get_blended_frames(const BlurSettings& settings, double input_fps) {
+	if (!settings.blur || settings.blur_amount <= 0.f || settings.blur_output_fps <= 0)
+		return {};
+
+	double fps = input_fps;
+
+	if (settings.timescale)
+		fps /= settings.input_timescale;
+
+	if (settings.interpolate) {
+		// multipliers are relative to the fps before pre-interpolation
+		auto interpolated_fps = parse_fps_setting(settings.interpolated_fps, fps);
+		if (!interpolated_fps)
+			return {};
+
+		if (settings.interpolation_method != "rife" && settings.pre_interpolate) {
+			auto pre_interpolated_fps = parse_fps_setting(settings.pre_interpolated_fps, fps);
+			if (!pre_interpolated_fps)
+				return {};
+
+			fps = std::max(fps, *pre_interpolated_fps);
+		}
+
+		fps = std::max(fps, *interpolated_fps);
+	}
+
+	if (settings.timescale)
+		fps *= settings.output_timescale;
+
+	int frame_gap = static_cast<int>(fps / settings.blur_output_fps);
+	int blended_frames = static_cast<int>(static_cast<float>(frame_gap) * settings.blur_amount);
+
+	if (blended_frames <= 0)
+		return {};
+
+	// number of weights must be odd
+	if (blended_frames % 2 == 0)
+		blended_frames++;
+
+	return blended_frames;
+}
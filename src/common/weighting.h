@@ -0,0 +1,50 @@
+#pragma once
+
+#include "config_blur.h"
+#include "expression.h"
+
+// c++ versions of the weighting functions in vapoursynth/blur/weighting.py (originally from
+// https://github.com/siveroo/hfr-resampler). weights are computed once here and passed to the script as an array
+namespace weighting {
+	using Weights = std::vector<float>;
+
+	// named weightings. anything else is either a list of weights like [1,2,3] or a function of x
+	inline const std::vector<std::string> WEIGHTINGS = {
+		"gaussian", "gaussian_sym", "pyramid", "pyramid_sym", "custom_weight", "custom_function", "equal",
+	};
+
+	Weights scale_range(int frames, float a, float b);
+	Weights normalise(Weights weights);
+
+	Weights equal(int frames);
+	Weights gaussian(int frames, float standard_deviation, const std::pair<float, float>& bound);
+	Weights gaussian_sym(int frames, float standard_deviation, const std::pair<float, float>& bound);
+	Weights pyramid(int frames, bool reverse);
+	Weights pyramid_sym(int frames);
+	Weights custom_weight(int frames, const Weights& weights);
+	Weights custom_function(int frames, const expression::Program& function, const std::pair<float, float>& bound);
+
+	bool is_custom_weight(const std::string& weighting);
+
+	struct ValidateResult {
+		bool success;
+		std::string error_message;
+	};
+
+	// checks custom weight lists and functions without needing to render anything
+	ValidateResult validate(const BlurSettings& settings);
+
+	struct WeightsResult {
+		bool success;
+		Weights weights;
+		std::string error_message;
+	};
+
+	WeightsResult get_weights(const BlurSettings& settings, int frames);
+
+	// the compiled form of a custom weighting function, nothing for named weightings and weight lists
+	std::optional<expression::Program> get_custom_function(const BlurSettings& settings);
+
+	// number of frames blended into each output frame for a video at input_fps, matching what blur.py works out
+	std::optional<int> get_blended_frames(const BlurSettings& settings, double input_fps);
+}
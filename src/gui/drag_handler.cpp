@@ -5,33 +5,40 @@
 #include "tasks.h"
 
 void gui::drag_handler::DragTarget::dragEnter(os::DragEvent& ev) {
-	if (!gui::initialisation_res || !gui::initialisation_res->success)
+	// still accept drops while initialising, they're queued until it's done
+	if (const auto* initialisation = gui::get_initialisation_result(); initialisation && !initialisation->success)
 		return;
 
 	// v.dropResult(os::DropOperation::None); // TODO: what does this do? is it needed?
 
 	drag_position = ev.position();
 	dragging = true;
+
+	request_redraw(); // drag callbacks don't come through the event queue
 }
 
 void gui::drag_handler::DragTarget::dragLeave(os::DragEvent& ev) {
-	if (!gui::initialisation_res || !gui::initialisation_res->success)
+	if (const auto* initialisation = gui::get_initialisation_result(); initialisation && !initialisation->success)
 		return;
 
 	// todo: not triggering on windows?
 	drag_position = ev.position();
 	dragging = false;
+
+	request_redraw();
 }
 
 void gui::drag_handler::DragTarget::drag(os::DragEvent& ev) {
-	if (!gui::initialisation_res || !gui::initialisation_res->success)
+	if (const auto* initialisation = gui::get_initialisation_result(); initialisation && !initialisation->success)
 		return;
 
 	drag_position = ev.position();
+
+	request_redraw();
 }
 
 void gui::drag_handler::DragTarget::drop(os::DragEvent& ev) {
-	if (!gui::initialisation_res || !gui::initialisation_res->success)
+	if (const auto* initialisation = gui::get_initialisation_result(); initialisation && !initialisation->success)
 		return;
 
 	ev.acceptDrop(true);
@@ -66,4 +73,6 @@ void gui::drag_handler::DragTarget::drop(os::DragEvent& ev) {
 	}
 
 	dragging = false;
+
+	request_redraw();
 }
@@ -54,18 +54,10 @@ bool gui::event_handler::process_event(const os::Event& event) {
 }
 
 bool gui::event_handler::handle_events(
-	bool rendered_last
+	double timeout
 ) { // https://github.com/aseprite/aseprite/blob/45c2a5950445c884f5d732edc02989c3fb6ab1a6/src/ui/manager.cpp#L393
-	const static int default_tickrate = 60;
-	const static double default_timeout = 1.f / default_tickrate;
-
 	bool processed_an_event = false;
 
-	double timeout = rendered_last
-	                     ? 0.0              // < an animation is playing or something, so be quick
-	                     : default_timeout; // < nothing's happening so take your time - but still be fast enough for
-	                                        // the ui to update occasionally to see if it wants to render
-
 	while (true) {
 		os::Event event;
 
@@ -3,5 +3,5 @@
 
 namespace gui::event_handler {
 	bool process_event(const os::Event& event);
-	bool handle_events(bool rendered_last);
+	bool handle_events(double timeout); // blocks for up to timeout seconds waiting for the first event
 }
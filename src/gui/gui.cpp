@@ -13,7 +13,10 @@ namespace {
 	float scale = 1.f;
 }
 
-void gui::update_vsync() {
+void gui::update_display_metrics(bool check_screen) {
+	if (!display_metrics_stale && !check_screen)
+		return;
+
 #ifdef _WIN32
 	HMONITOR screen_handle = (HMONITOR)window->screen()->nativeHandle();
 	static HMONITOR last_screen_handle;
@@ -25,30 +28,69 @@ void gui::update_vsync() {
 	static intptr_t last_screen_handle;
 #endif
 
-	if (screen_handle != last_screen_handle) {
-		const double rate = utils::get_display_refresh_rate(screen_handle);
+	if (!display_metrics_stale && screen_handle == last_screen_handle)
+		return;
+
+	display_metrics_stale = false;
+	last_screen_handle = screen_handle;
+
+	const double rate = utils::get_display_refresh_rate(screen_handle);
+	if (rate > 0.0)
 		vsync_frame_time = float(1.f / (rate + VSYNC_EXTRA_FPS));
-		u::log("switched screen, updated vsync_frame_time. refresh rate: {:.2f} hz", rate);
-		last_screen_handle = screen_handle;
+
+	// update dpi scaling
+	float new_scale = utils::get_display_scale_factor();
+	if (new_scale != scale) {
+		// window->setScale(new_scale);
+		scale = new_scale;
 	}
+
+	u::log("updated display metrics. refresh rate: {:.2f} hz, scale: {:.2f}", rate, scale);
 }
 
-void gui::event_loop() {
-	bool rendered_last = false;
+void gui::schedule_redraw(std::chrono::steady_clock::time_point time) {
+	if (!wake_time || time < *wake_time)
+		wake_time = time;
+}
+
+void gui::schedule_next_frame() {
+	schedule_redraw(std::chrono::steady_clock::now());
+}
 
+void gui::request_redraw() {
+	if (!window)
+		return;
+
+	if (redraw_pending.exchange(true, std::memory_order_acq_rel))
+		return; // one's already on the way
+
+	os::Event event;
+	window->queueEvent(event);
+}
+
+void gui::event_loop() {
 	while (!stop) {
+		// sleep until there's input, another thread asks for a redraw, or something scheduled is due. running
+		// animations schedule their next frame, so this only blocks once everything's settled
+		double timeout = os::EventQueue::kWithoutTimeout;
+		if (wake_time)
+			timeout = std::max(
+				std::chrono::duration<double>(*wake_time - std::chrono::steady_clock::now()).count(), 0.0
+			);
+
+		const bool handled_input = event_handler::handle_events(timeout);
+
 		auto frame_start = std::chrono::steady_clock::now();
 
-		update_vsync();
+		update_display_metrics(handled_input); // moving the window to another screen needs input, check then
 
-		// update dpi scaling
-		float new_scale = utils::get_display_scale_factor();
-		if (new_scale != scale) {
-			// window->setScale(new_scale);
-			scale = new_scale;
-		}
+		to_render |= handled_input;
+		to_render |= redraw_pending.exchange(false, std::memory_order_acq_rel);
+
+		if (wake_time && frame_start >= *wake_time)
+			to_render = true;
 
-		to_render |= event_handler::handle_events(rendered_last); // true if input handled
+		wake_time.reset(); // the frame reschedules anything still pending
 
 		const bool rendered = renderer::redraw_window(
 			window.get(), to_render
@@ -58,22 +100,23 @@ void gui::event_loop() {
 		u::log("rendered: {}, to render: {}", rendered, to_render);
 #endif
 
+		static bool painted_first_frame = false;
+		if (!painted_first_frame && (rendered || to_render)) {
+			painted_first_frame = true;
+			startup::trace("first frame painted");
+		}
+
 		// vsync
 		if (rendered || to_render) {
 			to_render = false;
-			rendered_last = true;
 
-#ifdef WIN32
-			u::sleep(vsync_frame_time); // killllll windowwssssss
-#else
-			auto target_time = frame_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-												 std::chrono::duration<float>(vsync_frame_time)
-											 );
-			std::this_thread::sleep_until(target_time);
-#endif
-		}
-		else {
-			rendered_last = false;
+			// block on the compositor's vblank where we can, otherwise pace to the cached refresh rate
+			if (!utils::wait_for_vblank()) {
+				auto target_time = frame_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+													 std::chrono::duration<float>(vsync_frame_time)
+												 );
+				std::this_thread::sleep_until(target_time);
+			}
 		}
 	}
 }
@@ -88,12 +131,12 @@ void gui::run() {
 
 	drag_handler::DragTarget drag_target;
 	window = window_manager::create_window(drag_target);
+	startup::trace("window created");
 
 	system->finishLaunching();
 	system->activateApp();
 
-	scale = utils::get_display_scale_factor();
-	// window->setScale(scale);
+	update_display_metrics(false);
 
 	event_queue = system->eventQueue(); // todo: move this maybe
 
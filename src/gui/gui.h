@@ -4,17 +4,40 @@ namespace gui {
 	inline os::WindowRef window;
 	inline os::EventQueue* event_queue;
 
-	inline std::optional<Blur::InitialisationResponse> initialisation_res;
+	// initialisation's result once it's finished, null while it's still running. safe to call from any thread
+	inline const Blur::InitialisationResponse* get_initialisation_result() {
+		return blur.initialisation_finished() ? &blur.wait_for_initialisation() : nullptr;
+	}
 
 	inline bool stop = false;
 	inline bool to_render = true;
 
+	// set by request_redraw, cleared by the event loop once it's picked it up. while it's set further requests don't
+	// queue more wake up events
+	inline std::atomic<bool> redraw_pending = false;
+
 	const inline float VSYNC_EXTRA_FPS = 50;
 	const inline float MIN_DELTA_TIME = 1.f / 10;
 	const inline float DEFAULT_DELTA_TIME = 1.f / 60;
 	inline double vsync_frame_time = DEFAULT_DELTA_TIME;
 
-	void update_vsync();
+	// display queries are slow (x11 opens a whole new connection for them), so the results are cached and only
+	// refreshed when the window moves screens or gets resized
+	inline bool display_metrics_stale = true;
+
+	// earliest time something on screen changes by itself (e.g. a notification expiring, or an animation's next
+	// frame). reset every frame and rescheduled by whatever's still waiting, main thread only. the event loop sleeps
+	// indefinitely when nothing's scheduled, so anything that moves on its own has to schedule itself
+	inline std::optional<std::chrono::steady_clock::time_point> wake_time;
+
+	void update_display_metrics(bool check_screen);
+	void schedule_redraw(std::chrono::steady_clock::time_point time);
+
+	// for effects that are still moving, draws another frame straight after this one (paced to vsync)
+	void schedule_next_frame();
+
+	// safe to call from any thread. any number of calls before the next frame results in a single wake up and redraw
+	void request_redraw();
 
 	void event_loop();
 	void run();
@@ -6,6 +6,8 @@
 
 #include "common/rendering.h"
 #include "common/rendering_frame.h"
+#include "common/weighting.h"
+#include "common/thumbnails.h"
 
 #include "drag_handler.h"
 #include "tasks.h"
@@ -15,7 +17,7 @@
 #include "ui/utils.h"
 #include "ui/render.h"
 
-#include "resources/fonts/eb_garamond.h"
+#include "resources/embedded_resources.h"
 #include "resources/fonts/dejavu_sans.h"
 
 #define DEBUG_RENDER 0
@@ -28,14 +30,27 @@ const int NOTIFICATIONS_PAD_Y = 10;
 
 const float FPS_SMOOTHING = 0.95f;
 
+namespace {
+	sk_sp<SkTypeface> get_header_typeface() {
+		static sk_sp<SkTypeface> typeface = utils::create_typeface(embedded_resources::eb_garamond);
+		return typeface;
+	}
+}
+
 void gui::renderer::init_fonts() {
-	fonts::font = utils::create_font_from_data(DejaVuSans_ttf.data(), DejaVuSans_ttf.size(), 11);
+	// everything else is laid out with this, so it's needed for the first frame anyway. it isn't compressed, skia uses
+	// the compiled in data directly
+	fonts::font = SkFont(utils::create_typeface(DejaVuSans_ttf), 11);
+}
 
-	fonts::header_font = utils::create_font_from_data(
-		EBGaramond_VariableFont_wght_ttf.data(), EBGaramond_VariableFont_wght_ttf.size(), 30
-	);
-	fonts::smaller_header_font = fonts::header_font;
-	fonts::smaller_header_font.setSize(18.f);
+const SkFont& gui::renderer::fonts::header_font() {
+	static const SkFont font(get_header_typeface(), 30);
+	return font;
+}
+
+const SkFont& gui::renderer::fonts::smaller_header_font() {
+	static const SkFont font(get_header_typeface(), 18);
+	return font;
 }
 
 void gui::renderer::set_cursor(os::NativeCursor cursor) {
@@ -58,19 +73,33 @@ void gui::renderer::components::render(
 	// todo: ui concept
 	// screen start|      [faded]last_video current_video [faded]next_video next_video2 next_video3 (+5) |
 	// screen end animate sliding in as it moves along the queue
+	if (!current) {
+		auto thumbnail_path = thumbnails::request(render.get_video_path(), render.get_video_info().duration);
+		if (thumbnail_path) {
+			ui::add_image(
+				std::format("video {} thumbnail", render.get_render_id()),
+				container,
+				*thumbnail_path,
+				gfx::Size(thumbnails::MAX_WIDTH / 2, thumbnails::MAX_HEIGHT / 2),
+				"",
+				gfx::rgba(255, 255, 255, 100)
+			);
+		}
+	}
+
 	ui::add_text(
 		std::format("video {} name text", render.get_render_id()),
 		container,
 		base::to_utf8(render.get_video_name()),
 		gfx::rgba(255, 255, 255, (current ? 255 : 100)),
-		fonts::smaller_header_font,
+		fonts::smaller_header_font(),
 		os::TextAlign::Center
 	);
 
 	if (!current)
 		return;
 
-	auto render_status = render.get_status();
+	auto render_status = render.get_progress();
 	int bar_width = 300;
 
 	std::string preview_path = render.get_preview_path().string();
@@ -90,6 +119,8 @@ void gui::renderer::components::render(
 	if (render_status.init) {
 		float render_progress = (float)render_status.current_frame / (float)render_status.total_frames;
 		bar_percent = u::lerp(bar_percent, render_progress, 5.f * delta_time, 0.005f);
+		if (bar_percent != render_progress)
+			schedule_next_frame(); // still catching up
 
 		ui::add_bar(
 			"progress bar",
@@ -139,12 +170,19 @@ void gui::renderer::components::render(
 
 void gui::renderer::components::main_screen(ui::Container& container, float delta_time) {
 	static float bar_percent = 0.f;
+	static std::optional<uint32_t> shown_finished_render_id;
+
+	auto queue = rendering.get_snapshot();
 
-	if (rendering.get_queue().empty() && !current_render_copy) {
+	// displays final state of the last render once where it would have been skipped otherwise
+	bool show_finished_render = queue->last_finished &&
+	                            queue->last_finished->get_render_id() != shown_finished_render_id;
+
+	if (queue->renders.empty() && !show_finished_render) {
 		bar_percent = 0.f;
 
 		gfx::Point title_pos = container.get_usable_rect().center();
-		title_pos.y = int(PAD_Y + fonts::header_font.getSize());
+		title_pos.y = int(PAD_Y + fonts::header_font().getSize());
 
 		ui::add_text_fixed(
 			"blur title text",
@@ -152,11 +190,11 @@ void gui::renderer::components::main_screen(ui::Container& container, float delt
 			title_pos,
 			"blur",
 			gfx::rgba(255, 255, 255, 255),
-			fonts::header_font,
+			fonts::header_font(),
 			os::TextAlign::Center
 		);
 
-		if (initialisation_res && !initialisation_res->success) {
+		if (const auto* initialisation = get_initialisation_result(); initialisation && !initialisation->success) {
 			ui::add_text(
 				"failed to initialise text",
 				main_container,
@@ -169,7 +207,7 @@ void gui::renderer::components::main_screen(ui::Container& container, float delt
 			ui::add_text(
 				"failed to initialise reason",
 				main_container,
-				initialisation_res->error_message,
+				initialisation->error_message,
 				gfx::rgba(255, 255, 255, 155),
 				fonts::font,
 				os::TextAlign::Center
@@ -202,38 +240,16 @@ void gui::renderer::components::main_screen(ui::Container& container, float delt
 	else {
 		bool is_progress_shown = false;
 
-		rendering.lock();
-		{
-			auto current_render = rendering.get_current_render();
-
-			// displays final state of the current render once where it would have been skipped otherwise
-			auto render_current_edge_case = [&] {
-				if (!current_render_copy)
-					return;
-
-				if (current_render) {
-					if ((*current_render)->get_render_id() == (*current_render_copy).get_render_id()) {
-						u::log("render final frame: wasnt deleted so just render normally");
-						return;
-					}
-				}
-
-				u::log("render final frame: it was deleted bro, rendering separately");
-
-				components::render(container, *current_render_copy, true, delta_time, is_progress_shown, bar_percent);
-
-				current_render_copy.reset();
-			};
-
-			render_current_edge_case();
+		if (show_finished_render) {
+			components::render(container, *queue->last_finished, true, delta_time, is_progress_shown, bar_percent);
+			shown_finished_render_id = queue->last_finished->get_render_id();
+		}
 
-			for (const auto [i, render] : u::enumerate(rendering.get_queue())) {
-				bool current = current_render && render.get() == current_render.value();
+		for (const auto& render : queue->renders) {
+			bool current = render == queue->current;
 
-				components::render(container, *render, current, delta_time, is_progress_shown, bar_percent);
-			}
+			components::render(container, *render, current, delta_time, is_progress_shown, bar_percent);
 		}
-		rendering.unlock();
 
 		if (!is_progress_shown) {
 			bar_percent = 0.f; // Reset when no progress bar is shown
@@ -313,6 +329,41 @@ void gui::renderer::components::configs::options(ui::Container& container, BlurS
 			settings.blur_weighting,
 			fonts::font
 		);
+
+		// the real frame count depends on the input video, plot the kernel for a typical 60fps source
+		static const double graph_input_fps = 60.0;
+		if (auto blended_frames = weighting::get_blended_frames(settings, graph_input_fps)) {
+			// custom functions get compiled to work the weights out, so only redo it when an input changes
+			struct WeightsKey {
+				std::string weighting;
+				std::string bound;
+				float std_dev;
+				bool triangle_reverse;
+				int frames;
+
+				bool operator==(const WeightsKey& other) const = default;
+			};
+
+			static std::optional<WeightsKey> cached_key;
+			static weighting::WeightsResult cached_weights;
+
+			WeightsKey key{
+				.weighting = settings.blur_weighting,
+				.bound = settings.advanced.blur_weighting_bound,
+				.std_dev = settings.advanced.blur_weighting_gaussian_std_dev,
+				.triangle_reverse = settings.advanced.blur_weighting_triangle_reverse,
+				.frames = *blended_frames,
+			};
+
+			if (key != cached_key) {
+				cached_weights = weighting::get_weights(settings, *blended_frames);
+				cached_key = std::move(key);
+			}
+
+			if (cached_weights.success)
+				ui::add_weighting_graph("blur weighting graph", container, cached_weights.weights);
+		}
+
 		ui::add_slider("blur gamma", container, 1.f, 10.f, &settings.blur_gamma, "blur gamma: {:.2f}", fonts::font);
 	}
 
@@ -713,6 +764,59 @@ void gui::renderer::components::configs::options(ui::Container& container, BlurS
 			);
 		}
 
+		ui::add_slider(
+			"memory limit slider",
+			container,
+			config_blur::MIN_MEMORY_LIMIT,
+			32768,
+			&settings.advanced.memory_limit,
+			"memory limit: {} mb",
+			fonts::font
+		);
+
+		ui::add_checkbox(
+			"sequential decode checkbox",
+			container,
+			"sequential decode",
+			settings.advanced.sequential_decode,
+			fonts::font
+		);
+
+		static const int max_cpu_threads = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+
+		ui::add_slider(
+			"cpu threads slider",
+			container,
+			0,
+			max_cpu_threads,
+			&settings.advanced.cpu_threads,
+			"cpu threads: {}",
+			fonts::font,
+			{},
+			0.f,
+			"0 = all"
+		);
+
+		ui::add_checkbox(
+			"pin cpu threads checkbox", container, "pin cpu threads", settings.advanced.pin_cpu_threads, fonts::font
+		);
+
+#if defined(__linux__)
+		ui::add_checkbox(
+			"numa placement checkbox", container, "numa placement", settings.advanced.numa_placement, fonts::font
+		);
+#endif
+
+		if (!settings.gpu_encoding) {
+			ui::add_checkbox(
+				"auto tune encoder checkbox",
+				container,
+				"auto tune encoder",
+				settings.advanced.auto_tune_encoder,
+				fonts::font
+			);
+		}
+
 		ui::add_checkbox("debug checkbox", container, "debug", settings.advanced.debug, fonts::font);
 
 		/*
@@ -829,8 +933,10 @@ void gui::renderer::components::configs::preview(ui::Container& container, BlurS
 			if (settings == previewed_settings && !first && !just_added_sample_video)
 				return;
 
-			if (now - last_render_time < debounce_time)
+			if (now - last_render_time < debounce_time) {
+				schedule_redraw(last_render_time + debounce_time); // come back once it's settled
 				return;
+			}
 		}
 
 		u::log("generating config preview");
@@ -895,6 +1001,8 @@ void gui::renderer::components::configs::preview(ui::Container& container, BlurS
 			}
 
 			render->set_can_delete();
+
+			request_redraw();
 		}).detach();
 	};
 
@@ -1225,6 +1333,47 @@ void gui::renderer::components::configs::option_information(ui::Container& conta
 				"(overrides GPU & quality options)",
 			},
 		},
+		{
+			"memory limit slider",
+			{
+				"Maximum memory VapourSynth can use for its frame cache",
+				"(lowers render threads if the blur window doesn't fit)",
+			},
+		},
+		{
+			"sequential decode checkbox",
+			{
+				"Decodes the input in order instead of indexing it first",
+				"(starts instantly, not used with infinite deduplicate range)",
+			},
+		},
+		{
+			"cpu threads slider",
+			{
+				"Number of CPU threads used for rendering, split between blur and the encoder",
+			},
+		},
+		{
+			"pin cpu threads checkbox",
+			{
+				"Keeps blur and the encoder on separate CPU cores",
+				"(not supported on macOS)",
+			},
+		},
+		{
+			"numa placement checkbox",
+			{
+				"Keeps each render on a single NUMA node (CPU socket)",
+				"(spreads concurrent renders across nodes)",
+			},
+		},
+		{
+			"auto tune encoder checkbox",
+			{
+				"Picks the x264/x265 preset and threads based on how fast blur renders",
+				"(slower presets give smaller files when the encoder would be waiting anyway)",
+			},
+		},
 		// { "debug checkbox", { "Shows debug window and prints commands used by blur", } }
 		{
 			"copy dates checkbox",
@@ -1234,7 +1383,7 @@ void gui::renderer::components::configs::option_information(ui::Container& conta
 		},
 	};
 
-	std::string hovered = ui::get_hovered_id();
+	const std::string& hovered = ui::get_hovered_id();
 
 	if (hovered.empty())
 		return;
@@ -1321,6 +1470,8 @@ void gui::renderer::components::configs::screen(
 				on_load();
 				loading_config = false;
 				loaded_config = true;
+
+				request_redraw();
 			}).detach();
 		}
 
@@ -1412,7 +1563,16 @@ bool gui::renderer::redraw_window(os::Window* window, bool force_render) {
 	static float bg_overlay_shade = 0.f;
 	float last_fill_shade = bg_overlay_shade;
 	bg_overlay_shade = u::lerp(bg_overlay_shade, drag_handler::dragging ? 30.f : 0.f, 25.f * delta_time);
-	force_render |= bg_overlay_shade != last_fill_shade;
+	if (bg_overlay_shade != last_fill_shade) {
+		force_render = true;
+		schedule_next_frame(); // keep fading
+	}
+
+	// the overlay covers everything and a resize invalidates the whole surface, anything else only repaints what
+	// changed
+	static gfx::Rect last_rect;
+	bool full_redraw = DEBUG_RENDER || rect != last_rect || bg_overlay_shade != last_fill_shade;
+	last_rect = rect;
 
 	gfx::Rect nav_container_rect = rect;
 	nav_container_rect.h = 70;
@@ -1465,13 +1625,11 @@ bool gui::renderer::redraw_window(os::Window* window, bool force_render) {
 
 			components::main_screen(main_container, delta_time);
 
-			if (initialisation_res && initialisation_res->success) {
-				auto current_render = rendering.get_current_render();
-				if (current_render) {
+			if (const auto* initialisation = get_initialisation_result(); initialisation && initialisation->success) {
+				if (rendering.get_current_render()) {
 					ui::add_button("stop render button", nav_container, "Stop current render", fonts::font, [] {
-						auto current_render = rendering.get_current_render();
-						if (current_render)
-							(*current_render)->stop();
+						if (auto current_render = rendering.get_current_render())
+							current_render->stop();
 					});
 				}
 
@@ -1516,76 +1674,117 @@ bool gui::renderer::redraw_window(os::Window* window, bool force_render) {
 	want_to_render |= ui::update_container_frame(option_information_container, delta_time);
 	ui::on_update_frame_end();
 
-	if (!want_to_render && !force_render)
+	// element animations and scrolling are still moving
+	if (want_to_render)
+		schedule_next_frame();
+
+	gfx::Region damage;
+	for (auto* container : { &main_container,
+	                         &config_container,
+	                         &config_preview_container,
+	                         &option_information_container,
+	                         &nav_container,
+	                         &notification_container })
+	{
+		damage |= ui::take_container_damage(*container);
+	}
+
+	// damage has already been taken, so it has to be painted now even when nothing is animating (e.g. an element's
+	// data changed) or it'd be lost
+	if (!want_to_render && !force_render && damage.isEmpty())
 		// note: DONT RENDER ANYTHING ABOVE HERE!!! todo: render queue?
 		return false;
 
-	// background
-	render::rect_filled(surface, rect, gfx::rgba(0, 0, 0, 255));
+	if (full_redraw)
+		damage = gfx::Region(rect);
+	else
+		damage &= gfx::Region(rect);
+
+	if (damage.isEmpty())
+		return want_to_render;
+
+	// every pass walks all the containers, so past a handful of rects just repaint their bounds in one go
+	const static size_t max_damage_rects = 8;
+	if (damage.size() > max_damage_rects)
+		damage = gfx::Region(damage.bounds());
+
+	auto paint = [&](const gfx::Rect& clip_rect) {
+		// background
+		render::rect_filled(surface, clip_rect, gfx::rgba(0, 0, 0, 255));
 
 #if DEBUG_RENDER
-	{
-		// debug
-		static const int debug_box_size = 30;
-		static float x = rect.x2() - debug_box_size;
-		static float y = 100.f;
-		static bool right = false;
-		static bool down = true;
-		x += 1.f * (right ? 1 : -1);
-		y += 1.f * (down ? 1 : -1);
-
-		render::rect_filled(surface, gfx::Rect(x, y, debug_box_size, debug_box_size), gfx::rgba(255, 0, 0, 50));
-
-		if (right) {
-			if (x + debug_box_size > rect.x2())
-				right = false;
-		}
-		else {
-			if (x < 0)
-				right = true;
-		}
+		{
+			// debug
+			static const int debug_box_size = 30;
+			static float x = rect.x2() - debug_box_size;
+			static float y = 100.f;
+			static bool right = false;
+			static bool down = true;
+			x += 1.f * (right ? 1 : -1);
+			y += 1.f * (down ? 1 : -1);
+
+			render::rect_filled(surface, gfx::Rect(x, y, debug_box_size, debug_box_size), gfx::rgba(255, 0, 0, 50));
+
+			if (right) {
+				if (x + debug_box_size > rect.x2())
+					right = false;
+			}
+			else {
+				if (x < 0)
+					right = true;
+			}
 
-		if (down) {
-			if (y + debug_box_size > rect.y2())
-				down = false;
-		}
-		else {
-			if (y < 0)
-				down = true;
+			if (down) {
+				if (y + debug_box_size > rect.y2())
+					down = false;
+			}
+			else {
+				if (y < 0)
+					down = true;
+			}
 		}
-	}
 #endif
 
-	ui::render_container(surface, main_container);
-	ui::render_container(surface, config_container);
-	ui::render_container(surface, config_preview_container);
-	ui::render_container(surface, option_information_container);
-	ui::render_container(surface, nav_container);
-	ui::render_container(surface, notification_container);
+		ui::render_container(surface, main_container, clip_rect);
+		ui::render_container(surface, config_container, clip_rect);
+		ui::render_container(surface, config_preview_container, clip_rect);
+		ui::render_container(surface, option_information_container, clip_rect);
+		ui::render_container(surface, nav_container, clip_rect);
+		ui::render_container(surface, notification_container, clip_rect);
 
-	// file drop overlay
-	if ((int)bg_overlay_shade > 0)
-		render::rect_filled(surface, rect, gfx::rgba(255, 255, 255, (gfx::ColorComponent)bg_overlay_shade));
+		// file drop overlay
+		if ((int)bg_overlay_shade > 0)
+			render::rect_filled(surface, clip_rect, gfx::rgba(255, 255, 255, (gfx::ColorComponent)bg_overlay_shade));
 
 #if DEBUG_RENDER
-	if (fps != -1.f) {
-		gfx::Point fps_pos(rect.x2() - PAD_X, rect.y + PAD_Y);
-		render::text(
-			surface,
-			fps_pos,
-			gfx::rgba(0, 255, 0, 255),
-			std::format("{:.0f} fps", fps),
-			fonts::font,
-			os::TextAlign::Right
-		);
-	}
+		if (fps != -1.f) {
+			gfx::Point fps_pos(rect.x2() - PAD_X, rect.y + PAD_Y);
+			render::text(
+				surface,
+				fps_pos,
+				gfx::rgba(0, 255, 0, 255),
+				std::format("{:.0f} fps", fps),
+				fonts::font,
+				os::TextAlign::Right
+			);
+		}
 #endif
+	};
+
+	for (const gfx::Rect& damaged_rect : damage) {
+		surface->saveClip();
+		surface->clipRect(damaged_rect);
+
+		paint(damaged_rect);
+
+		surface->restoreClip();
+	}
 
 	// todo: whats this do
 	if (!window->isVisible())
 		window->setVisible(true);
 
-	window->invalidateRegion(gfx::Region(rect));
+	window->invalidateRegion(damage);
 
 	return want_to_render;
 }
@@ -1613,11 +1812,14 @@ void gui::renderer::add_notification(
 	for (auto& notification : notifications) {
 		if (notification.id == id) {
 			notification = new_notification;
+			request_redraw();
 			return;
 		}
 	}
 
 	notifications.emplace_back(new_notification);
+
+	request_redraw(); // can be called from other threads
 }
 
 void gui::renderer::add_notification(
@@ -1679,9 +1881,12 @@ void gui::renderer::render_notifications() {
 			it->on_click_fn
 		);
 
-		if (now > it->end_time)
+		if (now > it->end_time) {
 			it = notifications.erase(it);
-		else
+		}
+		else {
+			schedule_redraw(it->end_time);
 			++it;
+		}
 	}
 }
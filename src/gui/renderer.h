@@ -12,8 +12,10 @@ namespace ui {
 namespace gui::renderer {
 	namespace fonts {
 		inline SkFont font;
-		inline SkFont header_font;
-		inline SkFont smaller_header_font;
+
+		// only headings use eb garamond, it's inflated the first time one's drawn instead of holding up startup
+		const SkFont& header_font();
+		const SkFont& smaller_header_font();
 	}
 
 	struct Notification {
@@ -33,8 +35,6 @@ namespace gui::renderer {
 
 	inline bool just_added_sample_video = false;
 
-	inline std::optional<Render> current_render_copy;
-
 	void init_fonts();
 
 	void set_cursor(os::NativeCursor cursor);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef> // the generated sources skip the pch
+
+// compressed at build time from the files in resources/ by cmake/embed_resource.cmake
+namespace embedded_resources {
+	struct Resource {
+		const unsigned char* data;
+		size_t size;
+		size_t uncompressed_size;
+	};
+
+	extern const Resource eb_garamond;
+}
@@ -7,52 +7,29 @@
 #endif
 
 #include <common/rendering.h>
+#include <common/thumbnails.h>
 #include "gui.h"
 #include "gui/renderer.h"
 #include "gui/ui/ui.h"
+#include "gui/ui/helpers/image_loader.h"
 
-void tasks::run(const std::vector<std::string>& arguments) {
-	auto res = blur.initialise(false, true);
-
-	gui::initialisation_res = res;
+namespace {
+	std::mutex pending_files_mutex;
+	std::condition_variable pending_files_condition;
+	std::vector<std::wstring> pending_files;
 
-	rendering.set_progress_callback([] {
-		if (!gui::window)
+	void check_updates() {
+		auto update_res = Blur::check_updates();
+		if (!update_res.success || update_res.is_latest)
 			return;
 
-		std::optional<Render*> current_render_opt = rendering.get_current_render();
-		if (current_render_opt) {
-			Render& current_render = **current_render_opt;
-
-			RenderStatus status = current_render.get_status();
-			if (status.finished) {
-				u::log("current render is finished, copying it so its final state can be displayed once by gui");
-
-				// its about to be deleted, store a copy to be rendered at least once
-				gui::renderer::current_render_copy = current_render;
-				gui::to_render = true;
-			}
-		}
-
-		// idk what you're supposed to do to trigger a redraw in a separate thread!!! I dont do gui!!! this works
-		// tho :  ) todo: revisit this
-		os::Event event;
-		gui::window->queueEvent(event);
-	});
-
-	rendering.set_render_finished_callback([](Render* render, const RenderResult& result) {
-		gui::renderer::on_render_finished(render, result);
-	});
-
-	auto update_res = Blur::check_updates();
-	if (update_res.success && !update_res.is_latest) {
 		static const auto update_notification_duration = std::chrono::duration<float>(15.f);
 
 #if defined(WIN32) || defined(__APPLE__)
 		gui::renderer::add_notification(
 			std::format("There's a newer version ({}) available! Click to run the installer.", update_res.latest_tag),
 			ui::NotificationType::INFO,
-			[&] {
+			[update_res] {
 				const static std::string update_notification_id = "update progress notification";
 
 				gui::renderer::add_notification(
@@ -60,9 +37,13 @@ void tasks::run(const std::vector<std::string>& arguments) {
 				);
 
 				std::thread([update_res] {
-					Blur::update(update_res.latest_tag, [](const std::string& text) {
-						gui::renderer::add_notification(update_notification_id, text, ui::NotificationType::INFO);
-					});
+					Blur::update(
+						update_res.latest_tag,
+						[](const std::string& text) {
+							gui::renderer::add_notification(update_notification_id, text, ui::NotificationType::INFO);
+						},
+						update_res.installer_sha256
+					);
 
 					gui::stop = true;
 				}).detach();
@@ -75,7 +56,7 @@ void tasks::run(const std::vector<std::string>& arguments) {
 				"There's a newer version ({}) available! Click to go to the download page.", update_res.latest_tag
 			),
 			ui::NotificationType::INFO,
-			[&] {
+			[update_res] {
 				base::launcher::open_url(update_res.latest_tag_url);
 			},
 			update_notification_duration
@@ -83,6 +64,80 @@ void tasks::run(const std::vector<std::string>& arguments) {
 #endif
 	}
 
+	// probing files runs ffprobe, so it's done on its own thread instead of on whichever thread added them. it's not
+	// the render thread either so files added mid-render show up in the queue straight away
+	void queue_pending_files() {
+		std::vector<std::wstring> path_strs;
+		{
+			std::lock_guard lock(pending_files_mutex);
+			path_strs.swap(pending_files);
+		}
+
+		for (const std::wstring& path_str : path_strs) {
+			std::filesystem::path path = std::filesystem::canonical(path_str);
+			if (path.empty() || !std::filesystem::exists(path))
+				continue;
+
+			auto video_info = u::get_video_info(path);
+			if (!video_info.has_video_stream) {
+				gui::renderer::add_notification(
+					std::format("File is not a valid video or is unreadable: {}", base::to_utf8(path.wstring())),
+					ui::NotificationType::NOTIF_ERROR
+				);
+				continue;
+			}
+
+			u::log(L"queueing {}", path.wstring());
+
+			Render render(path, video_info);
+
+			if (gui::renderer::screen != gui::renderer::Screens::MAIN) {
+				gui::renderer::add_notification(
+					std::format("Queued '{}' for rendering", base::to_utf8(render.get_video_name())),
+					ui::NotificationType::INFO
+				);
+			}
+
+			rendering.queue_render(std::move(render));
+		}
+	}
+
+	void queue_files_thread() {
+		// files added while initialising wait here until it's done
+		if (!blur.wait_for_initialisation().success)
+			return;
+
+		while (true) {
+			{
+				std::unique_lock lock(pending_files_mutex);
+				pending_files_condition.wait(lock, [] {
+					return !pending_files.empty();
+				});
+			}
+
+			queue_pending_files();
+		}
+	}
+}
+
+void tasks::run(const std::vector<std::string>& arguments) {
+	// the window's already up by now, nothing here should hold it up
+	blur.start_initialisation(false, true);
+
+	rendering.set_progress_callback([] {
+		gui::request_redraw();
+	});
+
+	// background loads finishing just need a frame to show up in
+	thumbnails::set_ready_callback(gui::request_redraw);
+	image_loader::set_ready_callback(gui::request_redraw);
+
+	rendering.set_render_finished_callback([](Render* render, const RenderResult& result) {
+		gui::renderer::on_render_finished(render, result);
+	});
+
+	std::thread(check_updates).detach();
+
 	std::vector<std::wstring> wargs;
 	for (const auto argument : arguments) {
 		wargs.push_back(base::from_utf8(argument));
@@ -90,39 +145,26 @@ void tasks::run(const std::vector<std::string>& arguments) {
 
 	add_files(wargs); // todo: mac packaged app support (& linux? does it work?)
 
+	std::thread(queue_files_thread).detach();
+
+	const auto& initialisation = blur.wait_for_initialisation();
+	gui::request_redraw(); // shows either the main screen or the error
+
+	if (!initialisation.success)
+		return;
+
 	while (!gui::stop) {
 		rendering.render_videos();
 	}
 }
 
 void tasks::add_files(const std::vector<std::wstring>& path_strs) {
-	for (const std::wstring& path_str : path_strs) {
-		std::filesystem::path path = std::filesystem::canonical(path_str);
-		if (path.empty() || !std::filesystem::exists(path))
-			continue;
-
-		auto video_info = u::get_video_info(path);
-		if (!video_info.has_video_stream) {
-			gui::renderer::add_notification(
-				std::format("File is not a valid video or is unreadable: {}", base::to_utf8(path.wstring())),
-				ui::NotificationType::NOTIF_ERROR
-			);
-			continue;
-		}
-
-		u::log(L"queueing {}", path.wstring());
-
-		Render render(path, video_info);
-
-		if (gui::renderer::screen != gui::renderer::Screens::MAIN) {
-			gui::renderer::add_notification(
-				std::format("Queued '{}' for rendering", base::to_utf8(render.get_video_name())),
-				ui::NotificationType::INFO
-			);
-		}
-
-		rendering.queue_render(std::move(render));
+	{
+		std::lock_guard lock(pending_files_mutex);
+		pending_files.insert(pending_files.end(), path_strs.begin(), path_strs.end());
 	}
+
+	pending_files_condition.notify_one();
 }
 
 void tasks::add_sample_video(const std::wstring& path_str) {
@@ -3,6 +3,6 @@
 namespace tasks {
 	void run(const std::vector<std::string>& arguments);
 
-	void add_files(const std::vector<std::wstring>& path_strs);
+	void add_files(const std::vector<std::wstring>& path_strs); // safe from any thread, picked up by run()
 	void add_sample_video(const std::wstring& path_str);
 }
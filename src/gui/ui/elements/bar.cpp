@@ -51,20 +51,17 @@ ui::Element& ui::add_bar(
 	std::optional<gfx::Color> text_color,
 	std::optional<const SkFont*> font
 ) {
-	Element element(
-		id,
-		ElementType::BAR,
-		gfx::Rect(container.current_position, gfx::Size(bar_width, 6)),
-		BarElementData{
-			.percent_fill = percent_fill,
-			.background_color = background_color,
-			.fill_color = fill_color,
-			.bar_text = std::move(bar_text),
-			.text_color = text_color,
-			.font = font,
-		},
-		render_bar
+	auto& element = begin_element(
+		container, id, ElementType::BAR, gfx::Rect(container.current_position, gfx::Size(bar_width, 6)), render_bar
 	);
 
-	return *add_element(container, std::move(element), container.element_gap);
+	auto& data = set_data<BarElementData>(element);
+	data.percent_fill = percent_fill;
+	data.background_color = background_color;
+	data.fill_color = fill_color;
+	data.bar_text = std::move(bar_text);
+	data.text_color = text_color;
+	data.font = font;
+
+	return *add_element(container, element, container.element_gap);
 }
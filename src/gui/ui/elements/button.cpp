@@ -68,22 +68,23 @@ ui::Element& ui::add_button(
 
 	gfx::Size text_size = render::get_text_size(text, font);
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::BUTTON,
 		gfx::Rect(container.current_position, text_size + button_padding),
-		ButtonElementData{
-			.text = text,
-			.font = font,
-			.on_press = std::move(on_press),
-		},
 		render_button,
 		update_button
 	);
 
+	auto& data = set_data<ButtonElementData>(element);
+	data.text = text;
+	data.font = font;
+	data.on_press = std::move(on_press);
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 25.f } },
@@ -105,23 +105,24 @@ ui::Element& ui::add_checkbox(
 	gfx::Size text_size = render::get_text_size(label, font);
 	gfx::Size total_size(200, std::max(CHECKBOX_SIZE, font.getSize()));
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::CHECKBOX,
 		gfx::Rect(container.current_position, total_size),
-		CheckboxElementData{
-			.label = label,
-			.checked = &checked,
-			.font = font,
-			.on_change = std::move(on_change),
-		},
 		render_checkbox,
 		update_checkbox
 	);
 
+	auto& data = set_data<CheckboxElementData>(element);
+	data.label = label;
+	data.checked = &checked;
+	data.font = font;
+	data.on_change = std::move(on_change);
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 25.f } },
@@ -243,24 +243,25 @@ ui::Element& ui::add_dropdown(
 
 	gfx::Size total_size(200, font.getSize() + LABEL_GAP + font.getSize() + (DROPDOWN_PADDING.h * 2));
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::DROPDOWN,
 		gfx::Rect(container.current_position, total_size),
-		DropdownElementData{
-			.label = label,
-			.options = options,
-			.selected = &selected,
-			.font = font,
-			.on_change = std::move(on_change),
-		},
 		render_dropdown,
 		update_dropdown
 	);
 
+	auto& data = set_data<DropdownElementData>(element);
+	data.label = label;
+	data.options = options;
+	data.selected = &selected;
+	data.font = font;
+	data.on_change = std::move(on_change);
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 25.f } },
@@ -1,6 +1,7 @@
 #include "../ui.h"
 
 #include "gui/ui/utils.h"
+#include "../helpers/image_loader.h"
 
 void ui::render_image(const Container& container, os::Surface* surface, const AnimatedElement& element) {
 	static const float rounding = 7.8f;
@@ -46,37 +47,34 @@ std::optional<ui::Element*> ui::add_image(
 	gfx::Color image_color
 ) {
 	os::SurfaceRef image_surface;
-	os::SurfaceRef last_image_surface;
-
-	// get existing image
-	if (container.elements.contains(id)) {
-		Element& cached_element = *container.elements[id].element;
-		auto& image_data = std::get<ImageElementData>(cached_element.data);
-		if (image_data.image_id == image_id) { // edge cases this might not work, it's using current_frame, maybe image
-			                                   // gets written after ffmpeg reports progress? idk. good enough for now
-			image_surface = image_data.image_surface;
-		}
-		else {
-			last_image_surface = image_data.image_surface;
-		}
-	}
+	gfx::Size decoded_size = max_size;
 
-	// load image if new
-	if (!image_surface) {
-		image_surface = os::instance()->loadRgbaSurface(image_path.string().c_str());
+	// what's currently displayed, kept on screen until the new image has been decoded
+	if (auto it = container.elements.find(hash_id(id)); it != container.elements.end()) {
+		const auto& image_data = std::get<ImageElementData>(it->second.element->data);
+		if (image_data.image_surface) {
+			image_surface = image_data.image_surface;
 
-		if (!image_surface) {
-			u::log("{} failed to load image (id: {})", id, image_id);
-			if (last_image_surface) {
-				// use last image as fallback todo: this is a bit hacky make it better
-				image_surface = last_image_surface;
-			}
-			else {
-				return {};
+			// edge cases this might not work, it's using current_frame, maybe image gets written after ffmpeg reports
+			// progress? idk. good enough for now
+			// also re-decoded when the display size changes, the surface was scaled down to the old one
+			if (image_data.image_id != image_id || image_data.max_size != max_size) {
+				if (auto loaded_surface = image_loader::get(image_path, image_id, max_size)) {
+					image_surface = loaded_surface;
+				}
+				else {
+					// still showing the old one
+					image_id = image_data.image_id;
+					decoded_size = image_data.max_size;
+				}
 			}
 		}
+	}
 
-		u::log("{} loaded image (id: {})", id, image_id);
+	if (!image_surface) {
+		image_surface = image_loader::get(image_path, image_id, max_size);
+		if (!image_surface)
+			return {};
 	}
 
 	gfx::Rect image_rect(container.current_position, max_size);
@@ -103,18 +101,14 @@ std::optional<ui::Element*> ui::add_image(
 		image_rect.h = static_cast<int>(max_size.w / aspect_ratio);
 	}
 
-	Element element(
-		id,
-		ElementType::IMAGE,
-		image_rect,
-		ImageElementData{
-			.image_path = image_path,
-			.image_surface = image_surface,
-			.image_id = image_id,
-			.image_color = image_color,
-		},
-		render_image
-	);
+	auto& element = begin_element(container, id, ElementType::IMAGE, image_rect, render_image);
+
+	auto& data = set_data<ImageElementData>(element);
+	data.image_path = image_path;
+	data.image_surface = image_surface;
+	data.image_id = image_id;
+	data.max_size = decoded_size;
+	data.image_color = image_color;
 
-	return add_element(container, std::move(element), container.element_gap);
+	return add_element(container, element, container.element_gap);
 }
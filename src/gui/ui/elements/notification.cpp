@@ -100,7 +100,7 @@ ui::Element& ui::add_notification(
 	gfx::Size notification_size = { 230, 100 }; // height is a maximum to start with
 	const int line_height = font.getSize() + 5;
 
-	std::vector<std::string> lines = render::wrap_text(
+	const auto& lines = render::wrap_text(
 		text, notification_size - (NOTIFICATION_TEXT_PADDING * 2 + 1), font, line_height
 	); // +1 idk todo: it looks bad otherwise sometimes
 
@@ -109,24 +109,25 @@ ui::Element& ui::add_notification(
 
 	// now that we've calculated the notification size, add text padding
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::NOTIFICATION,
 		gfx::Rect(container.current_position, notification_size),
-		NotificationElementData{
-			.lines = lines,
-			.type = type,
-			.font = font,
-			.line_height = line_height,
-			.on_click = std::move(on_click),
-		},
 		render_notification,
 		update_notification
 	);
 
+	auto& data = set_data<NotificationElementData>(element);
+	data.lines = lines;
+	data.type = type;
+	data.font = font;
+	data.line_height = line_height;
+	data.on_click = std::move(on_click);
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 5.f } },
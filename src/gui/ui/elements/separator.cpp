@@ -64,15 +64,15 @@ void ui::render_separator(const Container& container, os::Surface* surface, cons
 }
 
 ui::Element& ui::add_separator(const std::string& id, Container& container, SeparatorStyle style) {
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::SEPARATOR,
 		gfx::Rect(container.current_position, gfx::Size(200, container.element_gap)),
-		SeparatorElementData{
-			.style = style,
-		},
 		render_separator
 	);
 
-	return *add_element(container, std::move(element), container.element_gap);
+	set_data<SeparatorElementData>(element).style = style;
+
+	return *add_element(container, element, container.element_gap);
 }
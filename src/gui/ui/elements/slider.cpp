@@ -214,27 +214,28 @@ ui::Element& ui::add_slider(
 	if (tooltip != "")
 		slider_size.h += LINE_HEIGHT_ADD + text_size;
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::SLIDER,
 		gfx::Rect(container.current_position, slider_size),
-		SliderElementData{
-			.min_value = min_value,
-			.max_value = max_value,
-			.current_value = value,
-			.label_format = label_format,
-			.font = font,
-			.on_change = std::move(on_change),
-			.precision = precision,
-			.tooltip = tooltip,
-		},
 		render_slider,
 		update_slider
 	);
 
+	auto& data = set_data<SliderElementData>(element);
+	data.min_value = min_value;
+	data.max_value = max_value;
+	data.current_value = value;
+	data.label_format = label_format;
+	data.font = font;
+	data.on_change = std::move(on_change);
+	data.precision = precision;
+	data.tooltip = tooltip;
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 25.f } },
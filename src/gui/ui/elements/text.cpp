@@ -11,23 +11,72 @@ namespace {
 		return lines.size() * get_line_spacing(container, font);
 	}
 
-	std::vector<std::string> wrap_lines(
-		const ui::Container& container, const std::vector<std::string>& lines, const SkFont& font
+	// wraps into out, assigning over the lines it already has so their buffers are reused
+	void wrap_lines(
+		const ui::Container& container,
+		const std::vector<std::string>& lines,
+		const SkFont& font,
+		std::vector<std::string>& out
 	) {
 		auto size = container.get_usable_rect().size();
 
-		std::vector<std::string> wrapped_lines;
+		size_t count = 0;
+		auto append = [&](const std::string& line) {
+			if (count < out.size())
+				out[count] = line;
+			else
+				out.push_back(line);
+
+			count++;
+		};
 
 		for (const auto& line : lines) {
-			auto wrapped = render::wrap_text(line, size, font);
+			const auto& wrapped = render::wrap_text(line, size, font);
 
-			if (wrapped.size() > 1)
-				wrapped_lines.insert(wrapped_lines.end(), wrapped.begin(), wrapped.end());
+			if (wrapped.size() > 1) {
+				for (const auto& wrapped_line : wrapped)
+					append(wrapped_line);
+			}
 			else
-				wrapped_lines.push_back(line);
+				append(line);
 		}
 
-		return wrapped_lines;
+		out.resize(count);
+	}
+
+	// set_lines fills in the element's lines, the rest is shared by every add_text variant. fixed text is placed at
+	// its position instead of flowing with the container
+	template<typename SetLines>
+	ui::Element& add_text_element(
+		const std::string& id,
+		ui::Container& container,
+		std::optional<gfx::Point> fixed_position,
+		gfx::Color color,
+		const SkFont& font,
+		os::TextAlign align,
+		ui::TextStyle style,
+		SetLines&& set_lines
+	) {
+		// the height depends on how the lines wrap, the rect is set once they have been
+		bool fixed = fixed_position.has_value();
+		auto& element = ui::begin_element(container, id, ui::ElementType::TEXT, {}, ui::render_text, {}, fixed);
+
+		auto& data = ui::set_data<ui::TextElementData>(element);
+		set_lines(data.lines);
+		data.color = color;
+		data.font = font;
+		data.align = align;
+		data.style = style;
+
+		int text_height = get_text_height(container, data.lines, font);
+
+		if (fixed_position)
+			element.rect = gfx::Rect(*fixed_position, gfx::Size(0, text_height)); // todo: set width
+		else
+			element.rect =
+				gfx::Rect(container.current_position, gfx::Size(container.get_usable_rect().w, text_height));
+
+		return *ui::add_element(container, element, container.element_gap);
 	}
 }
 
@@ -89,33 +138,23 @@ ui::Element& ui::add_text(
 	os::TextAlign align,
 	TextStyle style
 ) {
-	auto lines = render::wrap_text(text, container.get_usable_rect().size(), font);
-
-	return add_text(id, container, lines, color, font, align, style);
+	return add_text_element(id, container, {}, color, font, align, style, [&](std::vector<std::string>& lines) {
+		lines = render::wrap_text(text, container.get_usable_rect().size(), font);
+	});
 }
 
 ui::Element& ui::add_text(
 	const std::string& id,
 	Container& container,
-	std::vector<std::string> lines,
+	const std::vector<std::string>& lines,
 	gfx::Color color,
 	const SkFont& font,
 	os::TextAlign align,
 	TextStyle style
 ) {
-	lines = wrap_lines(container, lines, font);
-
-	int text_height = get_text_height(container, lines, font);
-
-	Element element(
-		id,
-		ElementType::TEXT,
-		gfx::Rect(container.current_position, gfx::Size(container.get_usable_rect().w, text_height)),
-		TextElementData{ .lines = lines, .color = color, .font = font, .align = align, .style = style },
-		render_text
-	);
-
-	return *add_element(container, std::move(element), container.element_gap);
+	return add_text_element(id, container, {}, color, font, align, style, [&](std::vector<std::string>& out) {
+		wrap_lines(container, lines, font, out);
+	});
 }
 
 ui::Element& ui::add_text_fixed(
@@ -128,40 +167,22 @@ ui::Element& ui::add_text_fixed(
 	os::TextAlign align,
 	TextStyle style
 ) {
-	auto lines = render::wrap_text(text, container.get_usable_rect().size(), font);
-
-	return add_text_fixed(id, container, position, lines, color, font, align, style);
+	return add_text_element(id, container, position, color, font, align, style, [&](std::vector<std::string>& lines) {
+		lines = render::wrap_text(text, container.get_usable_rect().size(), font);
+	});
 }
 
 ui::Element& ui::add_text_fixed(
 	const std::string& id,
 	Container& container,
 	const gfx::Point& position,
-	std::vector<std::string> lines,
+	const std::vector<std::string>& lines,
 	gfx::Color color,
 	const SkFont& font,
 	os::TextAlign align,
 	TextStyle style
 ) {
-	lines = wrap_lines(container, lines, font);
-
-	int text_height = get_text_height(container, lines, font);
-
-	Element element(
-		id,
-		ElementType::TEXT,
-		gfx::Rect(position, gfx::Size(0, text_height)), // todo: set width
-		TextElementData{
-			.lines = lines,
-			.color = color,
-			.font = font,
-			.align = align,
-			.style = style,
-		},
-		render_text,
-		{},
-		true
-	);
-
-	return *add_element(container, std::move(element), container.element_gap);
+	return add_text_element(id, container, position, color, font, align, style, [&](std::vector<std::string>& out) {
+		wrap_lines(container, lines, font, out);
+	});
 }
@@ -47,7 +47,7 @@ void ui::render_text_input(const Container& container, os::Surface* surface, con
 
 	render::text(surface, pos.label_pos, gfx::rgba(255, 255, 255, anim * 255), input_data.placeholder, input_data.font);
 
-	auto& input = input_map.at(element.element->id);
+	auto& input = input_map.at(element.id);
 	input->render(surface, input_data.font, pos.input_rect, anim, hover_anim, focus_anim, input_data.placeholder);
 }
 
@@ -56,7 +56,7 @@ bool ui::update_text_input(const Container& container, AnimatedElement& element)
 	auto& hover_anim = element.animations.at(hasher("hover"));
 	auto& focus_anim = element.animations.at(hasher("focus"));
 
-	auto& input = input_map.at(element.element->id);
+	auto& input = input_map.at(element.id);
 
 	auto pos = get_positions(input_data, element);
 
@@ -129,23 +129,24 @@ ui::Element& ui::add_text_input(
 			)
 		);
 
-	Element element(
+	auto& element = begin_element(
+		container,
 		id,
 		ElementType::TEXT_INPUT,
 		gfx::Rect(container.current_position, input_size),
-		TextInputElementData{
-			.text = &text,
-			.placeholder = placeholder,
-			.font = font,
-			.on_change = std::move(on_change),
-		},
 		render_text_input,
 		update_text_input
 	);
 
+	auto& data = set_data<TextInputElementData>(element);
+	data.text = &text;
+	data.placeholder = placeholder;
+	data.font = font;
+	data.on_change = std::move(on_change);
+
 	return *add_element(
 		container,
-		std::move(element),
+		element,
 		container.element_gap,
 		{
 			{ hasher("main"), { .speed = 25.f } },
@@ -0,0 +1,75 @@
+#include <utility>
+
+#include "../ui.h"
+#include "../render.h"
+#include "../utils.h"
+
+const gfx::Size GRAPH_SIZE(200, 50);
+const int BAR_GAP = 1;
+
+void ui::render_weighting_graph(const Container& container, os::Surface* surface, const AnimatedElement& element) {
+	const auto& graph_data = std::get<WeightingGraphElementData>(element.element->data);
+	float anim = element.animations.at(hasher("main")).current;
+
+	const gfx::Rect& rect = element.element->rect;
+
+	render::rect_filled(surface, rect, utils::adjust_color(gfx::rgba(255, 255, 255, 10), anim));
+
+	if (graph_data.weights.empty())
+		return;
+
+	float max_weight = *std::ranges::max_element(graph_data.weights);
+	if (max_weight <= 0.f)
+		return;
+
+	gfx::Color bar_color = utils::adjust_color(gfx::rgba(255, 255, 255, 125), anim);
+
+	auto count = static_cast<int>(graph_data.weights.size());
+	float bar_width = static_cast<float>(rect.w) / count;
+
+	// draw as a line once there are too many weights for the bars to be visible
+	if (bar_width < 2 + BAR_GAP) {
+		gfx::Point last_point;
+
+		for (int i = 0; i < count; i++) {
+			gfx::Point point(
+				rect.x + static_cast<int>((i + 0.5f) * bar_width),
+				rect.y2() - static_cast<int>(rect.h * (graph_data.weights[i] / max_weight))
+			);
+
+			if (i > 0)
+				render::line(surface, last_point, point, bar_color);
+
+			last_point = point;
+		}
+
+		return;
+	}
+
+	for (int i = 0; i < count; i++) {
+		int bar_height = std::max(1, static_cast<int>(rect.h * (graph_data.weights[i] / max_weight)));
+
+		gfx::Rect bar_rect(
+			rect.x + static_cast<int>(i * bar_width),
+			rect.y2() - bar_height,
+			std::max(1, static_cast<int>(bar_width) - BAR_GAP),
+			bar_height
+		);
+
+		render::rect_filled(surface, bar_rect, bar_color);
+	}
+}
+
+ui::Element& ui::add_weighting_graph(const std::string& id, Container& container, const std::vector<float>& weights) {
+	auto& element = begin_element(
+		container,
+		id,
+		ElementType::WEIGHTING_GRAPH,
+		gfx::Rect(container.current_position, GRAPH_SIZE),
+		render_weighting_graph
+	);
+
+	set_data<WeightingGraphElementData>(element).weights = weights;
+
+	return *add_element(container, element, container.element_gap);
+}
@@ -0,0 +1,132 @@
+#include "image_loader.h"
+
+namespace {
+	// the size is part of the key since surfaces are scaled down to it, a bigger request needs a new decode
+	struct Key {
+		std::filesystem::path path;
+		std::string image_id;
+		gfx::Size max_size;
+
+		bool operator==(const Key& other) const = default;
+	};
+
+	struct Job {
+		Key key;
+	};
+
+	struct CachedImage {
+		Key key;
+		os::SurfaceRef surface; // null if decoding failed
+	};
+
+	std::mutex mutex;
+	std::condition_variable jobs_condition;
+	std::deque<Job> jobs;
+	std::deque<CachedImage> cache; // oldest first
+	std::optional<std::function<void()>> ready_callback;
+	bool thread_started = false;
+
+	os::SurfaceRef decode(const Job& job) {
+		os::SurfaceRef surface = os::instance()->loadRgbaSurface(job.key.path.string().c_str());
+		if (!surface)
+			return nullptr;
+
+		// fit within the displayed size, never scale up
+		float scale = std::min(
+			{ 1.f,
+		      job.key.max_size.w / static_cast<float>(surface->width()),
+		      job.key.max_size.h / static_cast<float>(surface->height()) }
+		);
+
+		int width = std::max(1, static_cast<int>(surface->width() * scale));
+		int height = std::max(1, static_cast<int>(surface->height() * scale));
+
+		if (width == surface->width() && height == surface->height())
+			return surface;
+
+		os::SurfaceRef scaled = os::instance()->makeRgbaSurface(width, height);
+		scaled->drawSurface(
+			surface.get(),
+			surface->bounds(),
+			gfx::Rect(0, 0, width, height),
+			os::Sampling(os::Sampling::Filter::Linear, os::Sampling::Mipmap::Linear),
+			nullptr
+		);
+
+		return scaled;
+	}
+
+	void loader_thread() {
+		while (true) {
+			Job job;
+
+			{
+				std::unique_lock lock(mutex);
+				jobs_condition.wait(lock, [] {
+					return !jobs.empty();
+				});
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			os::SurfaceRef surface = decode(job);
+			if (!surface)
+				u::log("failed to load image {} (id: {})", job.key.path.string(), job.key.image_id);
+
+			std::optional<std::function<void()>> callback;
+
+			{
+				std::lock_guard lock(mutex);
+
+				if (cache.size() >= image_loader::CACHE_SIZE)
+					cache.pop_front();
+
+				cache.push_back({ .key = std::move(job.key), .surface = surface });
+
+				callback = ready_callback;
+			}
+
+			if (surface && callback)
+				(*callback)();
+		}
+	}
+}
+
+os::SurfaceRef image_loader::get(
+	const std::filesystem::path& path, const std::string& image_id, const gfx::Size& max_size
+) {
+	Key key{ .path = path, .image_id = image_id, .max_size = max_size };
+
+	std::lock_guard lock(mutex);
+
+	auto cached = std::ranges::find(cache, key, &CachedImage::key);
+	if (cached != cache.end())
+		return cached->surface;
+
+	// already waiting on this path? swap in the newer id and size instead of decoding both
+	auto queued = std::ranges::find(jobs, path, [](const Job& job) -> const std::filesystem::path& {
+		return job.key.path;
+	});
+
+	if (queued != jobs.end()) {
+		queued->key = std::move(key);
+		return nullptr;
+	}
+
+	jobs.push_back({ .key = std::move(key) });
+
+	if (!thread_started) {
+		thread_started = true;
+		std::thread(loader_thread).detach();
+	}
+
+	jobs_condition.notify_one();
+
+	return nullptr;
+}
+
+void image_loader::set_ready_callback(std::function<void()>&& callback) {
+	std::lock_guard lock(mutex);
+	ready_callback = std::move(callback);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// decodes images for ui::add_image on a background thread so the ui never waits on a jpeg. decoded images are scaled
+// down to the size they're displayed at and kept in a small cache keyed by path, image id and size. requests for a path
+// that's already waiting replace the older one, so a quickly changing preview only decodes the latest frame
+namespace image_loader {
+	const size_t CACHE_SIZE = 16;
+
+	// the decoded surface if it's ready, otherwise queues it and returns nothing. failed decodes return nothing
+	// until the id changes
+	os::SurfaceRef get(const std::filesystem::path& path, const std::string& image_id, const gfx::Size& max_size);
+
+	// called from the loader thread when a surface becomes ready
+	void set_ready_callback(std::function<void()>&& callback);
+}
@@ -9,6 +9,109 @@
 // todo: is creating a new paint instance every time significant to perf? shouldnt be
 
 namespace {
+	// most text on screen is the same from frame to frame, so measuring, wrapping and shaping are cached. entries are
+	// looked up by a hash of their inputs and the inputs are checked on a hit, so lookups never allocate
+	template<typename Key, typename Value>
+	class LruCache {
+		struct Entry {
+			size_t hash;
+			Key key;
+			Value value;
+		};
+
+		size_t m_capacity;
+		std::list<Entry> m_entries; // most recently used first
+		std::unordered_map<size_t, typename std::list<Entry>::iterator> m_lookup;
+
+	public:
+		explicit LruCache(size_t capacity) : m_capacity(capacity) {}
+
+		template<typename LookupKey>
+		Value* find(size_t hash, const LookupKey& key) {
+			auto it = m_lookup.find(hash);
+			if (it == m_lookup.end() || !(it->second->key == key))
+				return nullptr;
+
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			return &it->second->value;
+		}
+
+		Value& insert(size_t hash, Key key, Value value) {
+			if (auto it = m_lookup.find(hash); it != m_lookup.end()) {
+				// hash collision, the newer one wins
+				m_entries.erase(it->second);
+				m_lookup.erase(it);
+			}
+
+			if (m_entries.size() >= m_capacity) {
+				m_lookup.erase(m_entries.back().hash);
+				m_entries.pop_back();
+			}
+
+			m_entries.push_front({ .hash = hash, .key = std::move(key), .value = std::move(value) });
+			m_lookup[hash] = m_entries.begin();
+
+			return m_entries.front().value;
+		}
+	};
+
+	template<typename Text>
+	struct TextKey {
+		Text text;
+		SkFont font;
+		gfx::Size dimensions; // wrapping only
+		int line_height = 0;  // wrapping only
+
+		template<typename OtherText>
+		bool operator==(const TextKey<OtherText>& other) const {
+			return text == other.text && font == other.font && dimensions == other.dimensions &&
+			       line_height == other.line_height;
+		}
+
+		[[nodiscard]] size_t hash() const {
+			size_t hash = std::hash<std::string_view>()(text);
+
+			auto combine = [&](size_t value) {
+				hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+			};
+
+			combine(font.getTypeface() ? font.getTypeface()->uniqueID() : 0);
+			combine(std::hash<float>()(font.getSize()));
+			combine(std::hash<float>()(font.getScaleX()));
+			combine(static_cast<size_t>(font.getEdging()));
+			combine(std::hash<int>()(dimensions.w));
+			combine(std::hash<int>()(dimensions.h));
+			combine(std::hash<int>()(line_height));
+
+			return hash;
+		}
+	};
+
+	struct TextLayout {
+		SkScalar width;
+		sk_sp<SkTextBlob> blob; // built the first time it's drawn
+	};
+
+	const size_t LAYOUT_CACHE_SIZE = 2048;
+	const size_t WRAP_CACHE_SIZE = 256;
+
+	LruCache<TextKey<std::string>, TextLayout> layout_cache(LAYOUT_CACHE_SIZE);
+	LruCache<TextKey<std::string>, std::vector<std::string>> wrap_cache(WRAP_CACHE_SIZE);
+
+	TextLayout& get_text_layout(const std::string& text, const SkFont& font) {
+		TextKey<std::string_view> key{ .text = text, .font = font };
+		size_t hash = key.hash();
+
+		if (auto* layout = layout_cache.find(hash, key))
+			return *layout;
+
+		return layout_cache.insert(
+			hash,
+			{ .text = text, .font = font },
+			{ .width = font.measureText(text.c_str(), text.size(), SkTextEncoding::kUTF8) }
+		);
+	}
+
 	void rounded_rect(os::Surface* surface, const gfx::RectF& rect, os::Paint paint, float rounding) {
 		if (rect.isEmpty())
 			return;
@@ -166,23 +269,32 @@ void render::text(
 	const SkFont& font,
 	os::TextAlign align
 ) {
+	if (text.empty())
+		return;
+
 	os::Paint paint;
 	paint.color(colour);
 
 	// todo: clip string
 
-	// os::draw_text font broken with skia bruh - need to call skia func directly
-	SkTextUtils::Draw(
-		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast) aseprite code
-		&static_cast<os::SkiaSurface*>(surface)->canvas(),
-		text.c_str(),
-		text.size(),
-		SkTextEncoding::kUTF8,
-		SkIntToScalar(pos.x),
-		SkIntToScalar(pos.y),
-		font,
-		paint.skPaint(),
-		(SkTextUtils::Align)align
+	// os::draw_text font broken with skia bruh - need to call skia func directly. same as SkTextUtils::Draw, but the
+	// shaped blob and its width are cached
+	auto& layout = get_text_layout(text, font);
+	if (!layout.blob)
+		layout.blob = SkTextBlob::MakeFromText(text.c_str(), text.size(), font, SkTextEncoding::kUTF8);
+
+	if (!layout.blob)
+		return;
+
+	SkScalar x = SkIntToScalar(pos.x);
+	if (align == os::TextAlign::Center)
+		x -= layout.width / 2;
+	else if (align == os::TextAlign::Right)
+		x -= layout.width;
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast) aseprite code
+	static_cast<os::SkiaSurface*>(surface)->canvas().drawTextBlob(
+		layout.blob, x, SkIntToScalar(pos.y), paint.skPaint()
 	);
 }
 
@@ -226,11 +338,8 @@ void render::pop_clip_rect(os::Surface* surface) {
 // }
 
 gfx::Size render::get_text_size(const std::string& text, const SkFont& font) {
-	// Skia paint object to calculate text metrics
-	SkPaint paint;
-
 	// Get the width of the text
-	SkScalar text_width = font.measureText(text.c_str(), text.size(), SkTextEncoding::kUTF8);
+	SkScalar text_width = get_text_layout(text, font).width;
 
 	// The result will be a width and height structure
 	return { SkScalarTruncToInt(text_width), get_font_height(font) };
@@ -247,7 +356,23 @@ int render::get_font_height(const SkFont& font) {
 }
 
 // NOLINTBEGIN(readability-function-size,readability-function-cognitive-complexity) ai code idc
-std::vector<std::string> render::wrap_text(
+const std::vector<std::string>& render::wrap_text(
+	const std::string& text, const gfx::Size& dimensions, const SkFont& font, int line_height
+) {
+	TextKey<std::string_view> key{ .text = text, .font = font, .dimensions = dimensions, .line_height = line_height };
+	size_t hash = key.hash();
+
+	if (auto* lines = wrap_cache.find(hash, key))
+		return *lines;
+
+	return wrap_cache.insert(
+		hash,
+		{ .text = text, .font = font, .dimensions = dimensions, .line_height = line_height },
+		wrap_text_uncached(text, dimensions, font, line_height)
+	);
+}
+
+std::vector<std::string> render::wrap_text_uncached(
 	const std::string& text, const gfx::Size& dimensions, const SkFont& font, int line_height
 ) {
 	std::vector<std::string> lines;
@@ -59,7 +59,11 @@ namespace render {
 	gfx::Size get_text_size(const std::string& text, const SkFont& font);
 	int get_font_height(const SkFont& font);
 
-	std::vector<std::string> wrap_text(
+	// results are cached (lru) by text, font and size. the reference is only valid until the next call
+	const std::vector<std::string>& wrap_text(
+		const std::string& text, const gfx::Size& dimensions, const SkFont& font, int line_height = 0
+	);
+	std::vector<std::string> wrap_text_uncached(
 		const std::string& text, const gfx::Size& dimensions, const SkFont& font, int line_height = 0
 	);
 }
@@ -6,6 +6,7 @@
 #include "os/draw_text.h"
 
 const int SCROLLBAR_WIDTH = 3;
+const int DAMAGE_MARGIN = 6; // strokes, handles and descenders draw a little outside element rects
 
 namespace {
 	os::NativeCursor desired_cursor = os::NativeCursor::Arrow;
@@ -13,6 +14,30 @@ namespace {
 	ui::AnimatedElement* hovered_element_internal = nullptr;
 	std::string hovered_id;
 
+	bool is_stale(const ui::Container& container, const ui::AnimatedElement& element) {
+		return element.generation != container.generation;
+	}
+
+	bool z_order_less(const ui::AnimatedElement* lhs, const ui::AnimatedElement* rhs) {
+		return std::tie(lhs->z_index, lhs->order) < std::tie(rhs->z_index, rhs->order);
+	}
+
+	// the area an element can paint to
+	gfx::Rect get_paint_bounds(const ui::Container& container, const ui::AnimatedElement& element) {
+		// dropdowns draw their options list outside their rect
+		if (element.element->type == ui::ElementType::DROPDOWN)
+			return container.rect;
+
+		gfx::Rect bounds = element.element->rect;
+		bounds.enlarge(DAMAGE_MARGIN);
+		return bounds;
+	}
+
+	void add_damage(ui::Container& container, const gfx::Rect& rect) {
+		if (!rect.isEmpty())
+			container.damage |= gfx::Region(rect);
+	}
+
 	int get_content_height(const ui::Container& container) {
 		int total_height = container.current_position.y - container.get_usable_rect().y;
 
@@ -74,68 +99,109 @@ void ui::reset_container(
 	container.line_height = line_height;
 	container.background_color = background_color;
 
-	container.current_element_ids = {};
+	container.current_elements.clear(); // keeps its capacity for the next frame
+	container.generation++;
 	container.updated = false;
 	container.last_margin_bottom = 0;
 }
 
+ui::Element& ui::begin_element(
+	Container& container,
+	std::string_view id,
+	ElementType type,
+	const gfx::Rect& rect,
+	std::function<void(const Container&, os::Surface*, const AnimatedElement&)> render_fn,
+	std::optional<std::function<bool(const Container&, AnimatedElement&)>> update_fn,
+	bool fixed
+) {
+	size_t id_hash = hash_id(id);
+
+	auto [it, inserted] = container.elements.try_emplace(id_hash);
+	auto& animated_element = it->second;
+
+	if (inserted)
+		animated_element.id = id;
+
+	if (!animated_element.staging)
+		animated_element.staging = std::make_unique<Element>();
+
+	auto& element = *animated_element.staging;
+	element.id = id_hash;
+	element.type = type;
+	element.rect = rect;
+	element.orig_rect = rect;
+	element.fixed = fixed;
+	element.render_fn = std::move(render_fn);
+	element.update_fn = std::move(update_fn);
+
+	return element;
+}
+
 ui::Element* ui::add_element(
 	Container& container,
-	Element&& _element,
+	Element& element,
 	int margin_bottom,
-	const std::unordered_map<size_t, AnimationInitialisation>& animations
+	AnimationInitialisations animations
 ) {
 	// pad when switching element type
-	if (container.current_element_ids.size() > 0) {
-		auto& last_element_id = container.current_element_ids.back();
-		auto& last_element = container.elements[last_element_id];
+	if (!container.current_elements.empty()) {
+		const auto& last_element = *container.current_elements.back()->element;
 
 		static std::set ignore_types = { ElementType::SEPARATOR };
 
-		if (!ignore_types.contains(last_element.element->type) && !ignore_types.contains(_element.type)) {
-			if (_element.type != last_element.element->type) {
-				_element.rect.y += TYPE_SWITCH_PADDING;
+		if (!ignore_types.contains(last_element.type) && !ignore_types.contains(element.type)) {
+			if (element.type != last_element.type) {
+				element.rect.y += TYPE_SWITCH_PADDING;
 				container.current_position.y += TYPE_SWITCH_PADDING;
 			}
 		}
 	}
 
-	auto* element = add_element(container, std::move(_element), animations);
+	auto* added_element = add_element(container, element, animations);
 
 	// reset x in case it was same line
 	container.current_position.x = container.get_usable_rect().x;
 
-	container.current_position.y += element->rect.h + margin_bottom;
+	container.current_position.y += added_element->rect.h + margin_bottom;
 	container.last_margin_bottom = margin_bottom;
 
-	return element;
+	return added_element;
 }
 
-ui::Element* ui::add_element(
-	Container& container, Element&& _element, const std::unordered_map<size_t, AnimationInitialisation>& animations
-) {
-	auto& animated_element = container.elements[_element.id];
+ui::Element* ui::add_element(Container& container, Element& element, AnimationInitialisations animations) {
+	auto& animated_element = container.elements.at(element.id);
 
-	_element.orig_rect = _element.rect;
+	element.orig_rect = element.rect;
 
 	if (animated_element.element) {
-		if (animated_element.element->data != _element.data) {
+		if (animated_element.element->data != element.data) {
 			container.updated = true;
+			animated_element.dirty = true;
 		}
+
+		// the staged element becomes current either way (callbacks aren't compared, they may capture something new),
+		// and last frame's is staged to be filled in next frame
+		std::swap(animated_element.element, animated_element.staging);
 	}
 	else {
-		u::log("first added {}", _element.id);
+		u::log("first added {}", animated_element.id);
 
 		for (const auto& [animation_id, initialisation] : animations) {
 			animated_element.animations.emplace(
 				animation_id, AnimationState(initialisation.speed, initialisation.value)
 			);
 		}
+
+		animated_element.element = std::move(animated_element.staging);
+		animated_element.order = container.next_element_order++;
+
+		auto& sorted = container.z_sorted_elements;
+		sorted.insert(std::ranges::upper_bound(sorted, &animated_element, z_order_less), &animated_element);
 	}
 
-	animated_element.element = std::make_unique<ui::Element>(std::move(_element));
+	animated_element.generation = container.generation;
 
-	container.current_element_ids.push_back(animated_element.element->id);
+	container.current_elements.push_back(&animated_element);
 
 	return animated_element.element.get();
 }
@@ -145,11 +211,10 @@ void ui::add_spacing(Container& container, int spacing) {
 }
 
 void ui::set_next_same_line(Container& container) {
-	if (container.current_element_ids.empty())
+	if (container.current_elements.empty())
 		return;
 
-	const std::string& last_element_id = container.current_element_ids.back();
-	auto& last_element = container.elements[last_element_id].element;
+	auto& last_element = container.current_elements.back()->element;
 
 	container.current_position.x = last_element->rect.x2() + container.last_margin_bottom;
 	container.current_position.y = last_element->rect.y;
@@ -171,8 +236,8 @@ void ui::center_elements_in_container(Container& container, bool horizontal, boo
 
 	// Group elements by their y position
 	std::map<int, std::vector<Element*>> elements_by_y;
-	for (const auto& id : container.current_element_ids) {
-		auto& element = container.elements[id].element;
+	for (auto* animated_element : container.current_elements) {
+		auto& element = animated_element->element;
 
 		if (element->fixed)
 			continue;
@@ -229,7 +294,7 @@ void ui::center_elements_in_container(Container& container, bool horizontal, boo
 	}
 
 	// update original rects for scrolling
-	for (auto& [id, element] : container.elements)
+	for (auto& [id_hash, element] : container.elements)
 		element.element->orig_rect = element.element->rect;
 }
 
@@ -239,19 +304,13 @@ void ui::set_cursor(os::NativeCursor cursor) {
 	desired_cursor = cursor;
 }
 
-std::vector<decltype(ui::Container::elements)::iterator> ui::get_sorted_container_elements(Container& container) {
-	std::vector<decltype(container.elements)::iterator> sorted_elements;
-	sorted_elements.reserve(container.elements.size());
-
-	for (auto it = container.elements.begin(); it != container.elements.end(); ++it) {
-		sorted_elements.push_back(it);
-	}
-
-	std::ranges::stable_sort(sorted_elements, [](const auto& lhs, const auto& rhs) {
-		return lhs->second.z_index > rhs->second.z_index;
-	});
+const std::vector<ui::AnimatedElement*>& ui::get_sorted_container_elements(Container& container) {
+	// z_index can change after insertion (dropdowns raise themselves while open). that's rare, so check and only
+	// re-sort when something's actually out of place
+	if (!std::ranges::is_sorted(container.z_sorted_elements, z_order_less))
+		std::ranges::sort(container.z_sorted_elements, z_order_less);
 
-	return sorted_elements;
+	return container.z_sorted_elements;
 }
 
 bool ui::set_hovered_element(AnimatedElement& element) {
@@ -262,32 +321,34 @@ bool ui::set_hovered_element(AnimatedElement& element) {
 	return true;
 }
 
-std::string ui::get_hovered_id() {
+const std::string& ui::get_hovered_id() {
 	return hovered_id;
 }
 
 bool ui::update_container_input(Container& container) {
 	bool updated = false;
 
-	auto sorted_elements = get_sorted_container_elements(container);
+	// update all elements, front to back
+	for (auto* animated_element : std::ranges::reverse_view(get_sorted_container_elements(container))) {
+		auto& element = *animated_element;
 
-	// update all elements
-	for (auto& it : sorted_elements) {
-		const auto& id = it->first;
-		auto& element = it->second;
-
-		bool stale = std::ranges::find(container.current_element_ids, id) == container.current_element_ids.end();
-		if (stale)
+		if (is_stale(container, element))
 			continue;
 
 		if (active_element && &element != active_element)
 			continue;
 
-		if (element.element->update_fn)
-			updated |= (*element.element->update_fn)(container, element);
+		if (element.element->update_fn && (*element.element->update_fn)(container, element)) {
+			element.dirty = true;
+			updated = true;
+		}
 	}
 
-	hovered_id = hovered_element_internal ? hovered_element_internal->element->id : "";
+	// assigned rather than rebuilt so it keeps its buffer between frames
+	if (hovered_element_internal)
+		hovered_id = hovered_element_internal->id;
+	else
+		hovered_id.clear();
 
 	// scroll
 	if (keys::scroll_delta != 0.f || keys::scroll_delta_precise != 0.f) {
@@ -364,28 +425,47 @@ bool ui::update_container_frame(Container& container, float delta_time) {
 		container.scroll_y = u::lerp(container.scroll_y, 0.f, scroll_reset_speed * delta_time);
 	}
 
-	if (container.scroll_y != last_scroll_y)
+	if (container.scroll_y != last_scroll_y) {
 		need_to_render_animation_update |= true;
 
+		// everything moved, and the scrollbar with it
+		add_damage(container, container.rect);
+	}
+
 	// update elements
 	for (auto it = container.elements.begin(); it != container.elements.end();) {
-		auto& [id, element] = *it;
+		auto& element = it->second;
 
 		// hacky, idc.
 		element.element->rect.y = element.element->orig_rect.y - container.scroll_y;
 
 		auto& main_animation = element.animations.at(hasher("main"));
 
-		bool stale = std::ranges::find(container.current_element_ids, id) == container.current_element_ids.end();
+		bool stale = is_stale(container, element);
 		main_animation.set_goal(!stale ? 1.f : 0.f);
 
+		bool animated = false;
 		for (auto& [animation_id, animation] : element.animations) {
-			need_to_render_animation_update |= animation.update(delta_time);
+			animated |= animation.update(delta_time);
+		}
+
+		need_to_render_animation_update |= animated;
+
+		// repaint where it was and where it is now. the focused element is always repainted, its caret blinks
+		gfx::Rect paint_bounds = get_paint_bounds(container, element);
+		if (element.dirty || animated || paint_bounds != element.painted_rect || &element == active_element) {
+			add_damage(container, element.painted_rect);
+			add_damage(container, paint_bounds);
+
+			element.painted_rect = paint_bounds;
+			element.dirty = false;
 		}
 
 		if (stale && main_animation.complete) {
 			// animation complete and element stale, remove
-			u::log("removed {}", id);
+			u::log("removed {}", element.id);
+			add_damage(container, element.painted_rect);
+			std::erase(container.z_sorted_elements, &element);
 			it = container.elements.erase(it);
 			continue;
 		}
@@ -398,20 +478,24 @@ bool ui::update_container_frame(Container& container, float delta_time) {
 
 void ui::on_update_frame_end() {}
 
-void ui::render_container(os::Surface* surface, Container& container) {
+gfx::Region ui::take_container_damage(Container& container) {
+	gfx::Region damage;
+	std::swap(damage, container.damage);
+	return damage;
+}
+
+void ui::render_container(os::Surface* surface, Container& container, const std::optional<gfx::Rect>& clip_rect) {
 	if (container.background_color) {
 		render::rect_filled(surface, container.rect, *container.background_color);
 	}
 
 	// render::push_clip_rect(surface, container.rect); todo: fade or some shit but straight clipping looks poo
 
-	auto sorted_elements = get_sorted_container_elements(container);
-
-	for (auto& it : std::ranges::reverse_view(sorted_elements)) {
-		const auto& id = it->first;
-		auto& element = it->second;
+	for (auto* element : get_sorted_container_elements(container)) {
+		if (clip_rect && !clip_rect->intersects(get_paint_bounds(container, *element)))
+			continue;
 
-		element.element->render_fn(container, surface, element);
+		element->element->render_fn(container, surface, *element);
 	}
 
 	if (can_scroll(container)) {
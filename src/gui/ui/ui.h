@@ -24,7 +24,8 @@ namespace ui {
 		TEXT_INPUT,
 		CHECKBOX,
 		DROPDOWN,
-		SEPARATOR
+		SEPARATOR,
+		WEIGHTING_GRAPH
 	};
 
 	struct BarElementData {
@@ -80,10 +81,12 @@ namespace ui {
 		std::filesystem::path image_path;
 		os::SurfaceRef image_surface;
 		std::string image_id;
+		gfx::Size max_size; // what image_surface was decoded for
 		gfx::Color image_color;
 
 		bool operator==(const ImageElementData& other) const {
-			return image_path == other.image_path && image_id == other.image_id && image_color == other.image_color;
+			return image_path == other.image_path && image_id == other.image_id && max_size == other.max_size &&
+			       image_color == other.image_color;
 			// Skip image_surface comparison since it's a reference-counted pointer
 		}
 	};
@@ -177,6 +180,14 @@ namespace ui {
 		}
 	};
 
+	struct WeightingGraphElementData {
+		std::vector<float> weights;
+
+		bool operator==(const WeightingGraphElementData& other) const {
+			return weights == other.weights;
+		}
+	};
+
 	using ElementData = std::variant<
 		BarElementData,
 		TextElementData,
@@ -187,7 +198,8 @@ namespace ui {
 		TextInputElementData,
 		CheckboxElementData,
 		DropdownElementData,
-		SeparatorElementData>;
+		SeparatorElementData,
+		WeightingGraphElementData>;
 
 	struct AnimationState {
 		float speed;
@@ -219,37 +231,37 @@ namespace ui {
 		float value = 0.f;
 	};
 
+	// passed as a braced list by each add_* function, lives on the stack so adding an element doesn't allocate
+	using AnimationInitialisations = std::initializer_list<std::pair<size_t, AnimationInitialisation>>;
+
 	struct AnimatedElement;
 
 	struct Container;
 
 	struct Element {
-		std::string id;
-		ElementType type;
+		size_t id = 0; // hash of the id it was added with, see AnimatedElement::id for the name
+		ElementType type = ElementType::BAR;
 		gfx::Rect rect;
 		ElementData data;
 		std::function<void(const Container&, os::Surface*, const AnimatedElement&)> render_fn;
 		std::optional<std::function<bool(const Container&, AnimatedElement&)>> update_fn;
 		bool fixed = false;
 		gfx::Rect orig_rect;
-
-		Element(
-			std::string id,
-			ElementType type,
-			const gfx::Rect& rect,
-			ElementData data,
-			std::function<void(const Container&, os::Surface*, const AnimatedElement&)> render_fn,
-			std::optional<std::function<bool(const Container&, AnimatedElement&)>> update_fn = std::nullopt,
-			bool fixed = false
-		)
-			: id(std::move(id)), type(type), rect(rect), data(std::move(data)), render_fn(std::move(render_fn)),
-			  update_fn(std::move(update_fn)), fixed(fixed), orig_rect(rect) {}
 	};
 
 	struct AnimatedElement {
+		std::string id; // set once when the element is first added, later frames only hash the caller's id
 		std::unique_ptr<Element> element;
+		// what the builder fills in this frame. swapped with element when it's added, so the buffers from the frame
+		// before are reused and an unchanged element doesn't allocate
+		std::unique_ptr<Element> staging;
 		std::unordered_map<size_t, AnimationState> animations;
 		int z_index = 0;
+		uint64_t generation = 0; // container generation this was last added in, older means stale
+		uint64_t order = 0;      // creation order, breaks z_index ties so newer elements draw on top
+
+		bool dirty = true;       // data changed or input asked for a redraw since it was last painted
+		gfx::Rect painted_rect; // area it covered when last painted, repainted along with the new one when it changes
 	};
 
 	const inline AnimationInitialisation DEFAULT_ANIMATION = { .speed = 25.f };
@@ -257,8 +269,16 @@ namespace ui {
 	struct Container {
 		gfx::Rect rect;
 		std::optional<gfx::Color> background_color;
-		std::unordered_map<std::string, AnimatedElement> elements;
-		std::vector<std::string> current_element_ids;
+		// elements persist across frames and are updated in place when re-added, keyed on the hash of their id.
+		// unordered_map nodes don't move, so pointers into it stay valid until the element is removed
+		std::unordered_map<size_t, AnimatedElement> elements;
+		std::vector<AnimatedElement*> current_elements; // added this frame, in order
+		std::vector<AnimatedElement*> z_sorted_elements; // back to front, kept sorted as elements come and go
+
+		uint64_t generation = 0; // bumped by reset_container
+		uint64_t next_element_order = 0;
+
+		gfx::Region damage; // needs repainting, collected by update_container_frame and taken by the renderer
 
 		int element_gap = 15;
 		float line_height = 1.2f;
@@ -296,7 +316,20 @@ namespace ui {
 		}
 	};
 
-	inline auto hasher = std::hash<std::string>{};
+	// fnv-1a. element ids are hashed once per add, the hash is what containers look elements up by
+	constexpr size_t hash_id(std::string_view string) {
+		uint64_t hash = 14695981039346656037ull;
+		for (char ch : string) {
+			hash ^= static_cast<uint8_t>(ch);
+			hash *= 1099511628211ull;
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	// animation ids are always literals, so hash them at compile time
+	consteval size_t hasher(std::string_view string) {
+		return hash_id(string);
+	}
 
 	inline AnimatedElement* active_element = nullptr;
 
@@ -329,6 +362,8 @@ namespace ui {
 
 	void render_separator(const Container& container, os::Surface* surface, const AnimatedElement& element);
 
+	void render_weighting_graph(const Container& container, os::Surface* surface, const AnimatedElement& element);
+
 	void reset_container(
 		Container& container,
 		const gfx::Rect& rect,
@@ -338,18 +373,37 @@ namespace ui {
 		std::optional<gfx::Color> background_color = {}
 	);
 
+	// returns the element for id to fill in this frame, holding whatever it had the last time it was built so
+	// assigning into its data reuses those buffers. must be followed by add_element
+	Element& begin_element(
+		Container& container,
+		std::string_view id,
+		ElementType type,
+		const gfx::Rect& rect,
+		std::function<void(const Container&, os::Surface*, const AnimatedElement&)> render_fn,
+		std::optional<std::function<bool(const Container&, AnimatedElement&)>> update_fn = std::nullopt,
+		bool fixed = false
+	);
+
+	// switches the element's data over to T, keeping the existing data (and its buffers) when it's already a T
+	template<typename T>
+	T& set_data(Element& element) {
+		if (!std::holds_alternative<T>(element.data))
+			element.data.emplace<T>();
+
+		return std::get<T>(element.data);
+	}
+
 	Element* add_element(
 		Container& container,
-		Element&& _element,
+		Element& element,
 		int margin_bottom,
-		const std::unordered_map<size_t, AnimationInitialisation>& animations = { { hasher("main"),
-	                                                                                DEFAULT_ANIMATION } }
+		AnimationInitialisations animations = { { hasher("main"), DEFAULT_ANIMATION } }
 	);
 	Element* add_element(
 		Container& container,
-		Element&& _element,
-		const std::unordered_map<size_t, AnimationInitialisation>& animations = { { hasher("main"),
-	                                                                                DEFAULT_ANIMATION } }
+		Element& element,
+		AnimationInitialisations animations = { { hasher("main"), DEFAULT_ANIMATION } }
 	);
 
 	Element& add_bar(
@@ -377,7 +431,7 @@ namespace ui {
 	Element& add_text(
 		const std::string& id,
 		Container& container,
-		std::vector<std::string> lines,
+		const std::vector<std::string>& lines,
 		gfx::Color color,
 		const SkFont& font,
 		os::TextAlign align = os::TextAlign::Left,
@@ -399,7 +453,7 @@ namespace ui {
 		const std::string& id,
 		Container& container,
 		const gfx::Point& position,
-		std::vector<std::string> lines,
+		const std::vector<std::string>& lines,
 		gfx::Color color,
 		const SkFont& font,
 		os::TextAlign align = os::TextAlign::Left,
@@ -475,18 +529,20 @@ namespace ui {
 
 	Element& add_separator(const std::string& id, Container& container, SeparatorStyle style);
 
+	Element& add_weighting_graph(const std::string& id, Container& container, const std::vector<float>& weights);
+
 	void add_spacing(Container& container, int spacing);
 
 	void set_next_same_line(Container& container);
 
 	void center_elements_in_container(Container& container, bool horizontal = true, bool vertical = true);
 
-	std::vector<decltype(Container::elements)::iterator> get_sorted_container_elements(Container& container);
+	const std::vector<AnimatedElement*>& get_sorted_container_elements(Container& container);
 
 	void set_cursor(os::NativeCursor cursor);
 
 	bool set_hovered_element(AnimatedElement& element);
-	std::string get_hovered_id();
+	const std::string& get_hovered_id();
 
 	bool update_container_input(Container& container);
 	void on_update_input_start();
@@ -495,7 +551,12 @@ namespace ui {
 	bool update_container_frame(Container& container, float delta_time);
 	void on_update_frame_end();
 
-	void render_container(os::Surface* surface, Container& container);
+	gfx::Region take_container_damage(Container& container);
+
+	// clip_rect skips elements that can't touch it, the caller is expected to have clipped the surface to it
+	void render_container(
+		os::Surface* surface, Container& container, const std::optional<gfx::Rect>& clip_rect = {}
+	);
 
 	void on_frame_start();
 }
@@ -1,11 +1,15 @@
 #include "utils.h"
 
+#include <zlib.h>
+
 #ifdef _WIN32
 #	include <windows.h>
 #	include <shellscalingapi.h>
+#	include <dwmapi.h>
 #elif defined(__APPLE__)
 #	include <CoreGraphics/CoreGraphics.h>
 #	include <CoreVideo/CoreVideo.h>
+#	include <condition_variable>
 #	include <dlfcn.h>
 #	include <ApplicationServices/ApplicationServices.h>
 #else // X11
@@ -19,18 +23,45 @@ gfx::Color utils::adjust_color(const gfx::Color& color, float anim) {
 	); // seta is broken or smth i swear
 }
 
-SkFont utils::create_font_from_data(const unsigned char* font_data, size_t data_size, float font_height) {
-	sk_sp<SkData> sk_data = SkData::MakeWithCopy(font_data, data_size);
+sk_sp<SkTypeface> utils::create_typeface(const embedded_resources::Resource& resource) {
+	sk_sp<SkData> sk_data = SkData::MakeUninitialized(resource.uncompressed_size);
+
+	z_stream stream{};
+	stream.next_in = const_cast<Bytef*>(resource.data);
+	stream.avail_in = static_cast<uInt>(resource.size);
+	stream.next_out = static_cast<Bytef*>(sk_data->writable_data());
+	stream.avail_out = static_cast<uInt>(resource.uncompressed_size);
+
+	// 15 + 32: max window size, detect zlib or gzip header
+	if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+		u::log_error("failed to create font: couldn't initialise zlib");
+		return nullptr;
+	}
 
-	// Create a typeface from SkData
-	sk_sp<SkTypeface> typeface = SkTypeface::MakeFromData(sk_data);
+	int res = inflate(&stream, Z_FINISH);
+	inflateEnd(&stream);
 
-	if (!typeface) {
-		u::log("failed to create font");
-		return {};
+	if (res != Z_STREAM_END || stream.total_out != resource.uncompressed_size) {
+		u::log_error("failed to create font: decompression failed ({})", res);
+		return nullptr;
 	}
 
-	return { typeface, SkIntToScalar(font_height) };
+	sk_sp<SkTypeface> typeface = SkTypeface::MakeFromData(std::move(sk_data));
+
+	if (!typeface)
+		u::log_error("failed to create font");
+
+	return typeface;
+}
+
+sk_sp<SkTypeface> utils::create_typeface(std::span<const unsigned char> static_data) {
+	sk_sp<SkTypeface> typeface =
+		SkTypeface::MakeFromData(SkData::MakeWithoutCopy(static_data.data(), static_data.size()));
+
+	if (!typeface)
+		u::log_error("failed to create font");
+
+	return typeface;
 }
 
 // NOLINTBEGIN
@@ -264,3 +295,82 @@ float utils::get_display_scale_factor() {
 	return 1.0f;
 #endif
 }
+
+#if defined(__APPLE__)
+namespace {
+	// the display link calls back on its own thread every vblank, waiting for the next tick is the closest thing to a
+	// blocking vsync we get without a metal layer
+	struct DisplayLinkState {
+		std::mutex mutex;
+		std::condition_variable ticked;
+		uint64_t ticks = 0;
+		CVDisplayLinkRef link = nullptr;
+		bool failed = false;
+	};
+
+	CVReturn on_display_link_tick(
+		CVDisplayLinkRef /*link*/,
+		const CVTimeStamp* /*now*/,
+		const CVTimeStamp* /*output_time*/,
+		CVOptionFlags /*flags_in*/,
+		CVOptionFlags* /*flags_out*/,
+		void* context
+	) {
+		auto* state = static_cast<DisplayLinkState*>(context);
+		{
+			std::lock_guard lock(state->mutex);
+			state->ticks++;
+		}
+		state->ticked.notify_all();
+
+		return kCVReturnSuccess;
+	}
+}
+#endif
+
+bool utils::wait_for_vblank() {
+#ifdef _WIN32
+	// windows are presented through dwm, so its composition pass is the real vblank
+	BOOL composition_enabled = FALSE;
+	if (FAILED(DwmIsCompositionEnabled(&composition_enabled)) || !composition_enabled)
+		return false;
+
+	return SUCCEEDED(DwmFlush());
+#elif defined(__APPLE__)
+	// leaked on purpose, the display link thread can still be calling back while statics are destroyed at exit
+	static auto* state = new DisplayLinkState;
+
+	std::unique_lock lock(state->mutex);
+
+	if (state->failed)
+		return false;
+
+	if (!state->link) {
+		// follows whichever active display the link picks, which is the main one. when the window is on another
+		// screen with a different refresh rate this paces to the wrong one, same as the cached refresh rate would
+		if (CVDisplayLinkCreateWithActiveCGDisplays(&state->link) != kCVReturnSuccess ||
+		    CVDisplayLinkSetOutputCallback(state->link, on_display_link_tick, state) != kCVReturnSuccess ||
+		    CVDisplayLinkStart(state->link) != kCVReturnSuccess)
+		{
+			if (state->link)
+				CVDisplayLinkRelease(state->link);
+
+			state->link = nullptr;
+			state->failed = true;
+			return false;
+		}
+	}
+
+	// a display that's asleep stops ticking, don't hang the ui on it
+	const auto max_wait = std::chrono::milliseconds(100);
+
+	uint64_t ticks = state->ticks;
+	return state->ticked.wait_for(lock, max_wait, [&] {
+		return state->ticks != ticks;
+	});
+#else
+	// laf presents through XPutImage here, there's no swap chain to set an interval on and no vblank event without
+	// pulling in libdrm or the present extension. the caller paces to the cached refresh rate instead
+	return false;
+#endif
+}
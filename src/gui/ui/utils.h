@@ -1,9 +1,16 @@
 #pragma once
 
+#include "gui/resources/embedded_resources.h"
+
 namespace utils {
 	gfx::Color adjust_color(const gfx::Color& color, float anim);
 
-	SkFont create_font_from_data(const unsigned char* font_data, size_t data_size, float font_height);
+	// decompresses straight into the buffer skia keeps, so there's only ever one copy of the font in memory. share
+	// the result between every SkFont that uses it
+	sk_sp<SkTypeface> create_typeface(const embedded_resources::Resource& resource);
+
+	// for fonts compiled in uncompressed. skia reads the data in place, it has to outlive the typeface
+	sk_sp<SkTypeface> create_typeface(std::span<const unsigned char> static_data);
 
 	// NOLINTBEGIN
 #ifdef _WIN32
@@ -24,4 +31,7 @@ namespace utils {
 	);
 
 	float get_display_scale_factor();
+
+	// waits for the next vertical blank if the platform gives us a way to, returns false if it didn't
+	bool wait_for_vblank();
 }
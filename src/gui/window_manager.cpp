@@ -1,6 +1,7 @@
 
 #include "window_manager.h"
 
+#include "gui.h"
 #include "renderer.h"
 
 os::WindowRef gui::window_manager::create_window(os::DragTarget& drag_target) {
@@ -18,5 +19,6 @@ os::WindowRef gui::window_manager::create_window(os::DragTarget& drag_target) {
 }
 
 void gui::window_manager::on_resize(os::Window* window) {
+	display_metrics_stale = true; // dpi changes come through as resizes
 	renderer::redraw_window(window, true);
 }
@@ -20,15 +20,17 @@ if vars().get("macos_bundled") == "true":
 sys.path.insert(1, str(Path(__file__).parent))
 
 import blur.interpolate
+import blur.source
 
 model_path = Path(vars().get("rife_model", ""))
 gpu_index = vars().get("rife_gpu_index", 0)
 benchmark_video_path = Path(vars().get("benchmark_video_path", ""))
 
-if vars().get("enable_lsmash") == "true":
-    video = core.lsmas.LWLibavSource(source=benchmark_video_path, cache=0)
-else:
-    video = core.bs.VideoSource(source=benchmark_video_path, cachemode=0)
+video = blur.source.load(
+    benchmark_video_path,
+    index_cache_dir=vars().get("index_cache_dir"),
+    lsmash=vars().get("enable_lsmash") == "true",
+)
 
 video = blur.interpolate.interpolate_rife(
     video, video.fps * 3, model_path=model_path, gpu_index=gpu_index
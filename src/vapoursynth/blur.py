@@ -24,6 +24,9 @@ import blur.blending
 import blur.deduplicate
 import blur.deduplicate_rife
 import blur.interpolate
+import blur.memory
+import blur.source
+import blur.stream
 import blur.weighting
 import blur.adjust
 import blur.utils as u
@@ -32,6 +35,10 @@ video_path = Path(vars().get("video_path", ""))
 
 settings = json.loads(vars().get("settings", "{}"))
 
+# only passed when blur splits the cpu between vapoursynth and the encoder (cpu threads or pinning is set)
+if "num_threads" in settings:
+    core.num_threads = max(1, int(settings["num_threads"]))
+
 # validate some settings
 svp_interpolation_algorithm = u.coalesce(
     u.safe_int(settings["svp_interpolation_algorithm"]),
@@ -52,12 +59,36 @@ rife_gpu_index = settings["rife_gpu_index"]
 if rife_gpu_index == -1:  # haven't benchmarked yet..?
     rife_gpu_index = 0
 
-if vars().get("enable_lsmash") == "true":
-    video = core.lsmas.LWLibavSource(
-        source=video_path, cache=0, prefer_hw=3 if settings["gpu_decoding"] else 0
+# sequential decoding only keeps a window of recent frames, which isn't enough for deduplication without a range limit
+sequential_decode = settings["sequential_decode"] and "ffmpeg_path" in vars()
+if (
+    sequential_decode
+    and settings["deduplicate"]
+    and settings["deduplicate_method"] != "old"
+    and settings["deduplicate_range"] == -1
+):
+    print("infinite deduplicate range needs random access, not using sequential decode")
+    sequential_decode = False
+
+if sequential_decode:
+    window = 32 + core.num_threads * 2
+    if settings["deduplicate"] and settings["deduplicate_range"] > 0:
+        window += settings["deduplicate_range"] * 2
+
+    video = blur.stream.load(
+        video_path,
+        ffmpeg_path=vars()["ffmpeg_path"],
+        ffprobe_path=vars()["ffprobe_path"],
+        window=window,
+        frame_count=u.safe_int(vars().get("stream_frames")),
     )
 else:
-    video = core.bs.VideoSource(source=video_path, cachemode=0)
+    video = blur.source.load(
+        video_path,
+        index_cache_dir=vars().get("index_cache_dir"),
+        lsmash=vars().get("enable_lsmash") == "true",
+        gpu_decoding=settings["gpu_decoding"],
+    )
 
 if settings["deduplicate"] and settings["deduplicate_range"] != 0:
     deduplicate_range: int | None = int(settings["deduplicate_range"])
@@ -242,6 +273,16 @@ if settings["timescale"]:
             video, fpsnum=(video.fps * settings["output_timescale"])
         )
 
+# the largest number of source frames a single output frame depends on, used to size the frame cache
+frame_window = 1
+
+# the clip the blend reads its window of frames from, frames in the cache are this size rather than the output's
+blend_clip = video
+
+# set while the clip is in linear light, see blur.blending.to_linear
+linear_gamma = None
+linear_format = None
+
 # blurring
 if settings["blur"]:
     if settings["blur_amount"] > 0:
@@ -282,14 +323,15 @@ if settings["blur"]:
 
                     case "custom_weight":
                         return blur.weighting.divide(
-                            blended_frames, settings["blur_weighting"]
+                            blended_frames, json.loads(settings["blur_weighting"])
                         )
 
                     case "custom_function":
+                        # compiled by blur, the function's source is never evaluated here
                         return blur.weighting.custom(
                             blended_frames,
-                            settings["blur_weighting"],
-                            settings["blur_weighting_bound"],
+                            settings.get("weighting_program"),
+                            blur_weighting_bound,
                         )
 
                     case "equal":
@@ -302,17 +344,33 @@ if settings["blur"]:
                         else:
                             return do_weighting_fn("custom_function")
 
-            weights = do_weighting_fn(settings["blur_weighting"])
+            # weights are normally precomputed by blur, but they're only valid if the frame count matches. otherwise
+            # they're worked out here (custom functions from blur's compiled program)
+            precomputed_weights = settings.get("weights")
+            if precomputed_weights and precomputed_weights["frames"] == blended_frames:
+                weights = precomputed_weights["values"]
+            else:
+                weights = do_weighting_fn(settings["blur_weighting"])
+
+            frame_window = blended_frames
 
             gamma = float(settings["blur_gamma"])
-            if gamma == 1.0:
-                video = blur.blending.average(video, weights)
-            else:
-                video = blur.blending.average_bright(video, gamma, weights)
+            if gamma != 1.0:
+                # blend in linear light, encoding back happens after decimation so it only runs on output frames
+                linear_gamma = gamma
+                linear_format = video.format
+
+                video = blur.blending.to_linear(video, gamma)
+
+            blend_clip = video
+            video = blur.blending.average(video, weights)
 
     # set exact fps
     video = blur.interpolate.change_fps(video, settings["blur_output_fps"])
 
+    if linear_gamma is not None:
+        video = blur.blending.from_linear(video, linear_gamma, linear_format)
+
 # filters
 if settings["filters"]:
     if (
@@ -333,4 +391,9 @@ if settings["filters"]:
 
         video = core.resize.Point(video, format=original_format.id)
 
+if "memory_limit" in settings:
+    blur.memory.apply_budget(
+        blend_clip, frame_window, int(settings["memory_limit"]), settings["debug"]
+    )
+
 video.set_output()
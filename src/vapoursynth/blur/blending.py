@@ -83,38 +83,47 @@ def average(clip: vs.VideoNode, weights: list[float], divisor: float | None = No
     return core.akarin.Expr(clips, expr)
 
 
-def average_bright(
-    video: vs.VideoNode,
-    gamma: float,
-    weights: list[float],
-    divisor: float | None = None,
-):
+# decoding goes to 32-bit float rgb so the blend doesn't round away shadow detail. integer input (rgb, or yuv after
+# an integer conversion to 16-bit rgb) is decoded with a float output lookup table, one lookup per sample instead of a
+# pow. only float input is raised with Expr
+def to_linear(video: vs.VideoNode, gamma: float):
     orig_format = video.format
-    needs_conversion = orig_format.id != vs.RGBS
 
-    if needs_conversion:
+    if orig_format.sample_type == vs.INTEGER:
+        if orig_format.color_family != vs.RGB:
+            # 16-bit so the yuv -> rgb step doesn't band before decoding, the table's still only 65536 entries
+            video = core.resize.Bicubic(
+                video,
+                format=vs.RGB48,
+                matrix_in_s="709" if orig_format.color_family == vs.YUV else None,
+            )
+
+        in_peak = (1 << video.format.bits_per_sample) - 1
+
+        return core.std.Lut(
+            video,
+            function=lambda x: (x / in_peak) ** gamma,
+            floatout=True,
+        )
+
+    if orig_format.id != vs.RGBS:
         video = core.resize.Bicubic(
             video,
             format=vs.RGBS,
             matrix_in_s="709" if orig_format.color_family == vs.YUV else None,
         )
 
-    def gamma_correct(video, gamma):
-        expr = f"x {gamma} pow"
-        return core.std.Expr(video, expr=expr)
-        # return core.std.Levels(
-        #     video, gamma=gamma, min_in=0.0, max_in=1.0, min_out=0.0, max_out=1.0
-        # )
+    return core.std.Expr(video, expr=f"x {gamma} pow")
+
 
-    video = gamma_correct(video, gamma)
-    video = average(video, weights, divisor)
-    video = gamma_correct(video, 1.0 / gamma)
+def from_linear(video: vs.VideoNode, gamma: float, format: vs.VideoFormat):
+    video = core.std.Expr(video, expr=f"x 0 max {1.0 / gamma} pow")
 
-    if needs_conversion:
+    if video.format.id != format.id:
         video = core.resize.Bicubic(
             video,
-            format=orig_format.id,
-            matrix_s="709" if orig_format.color_family == vs.YUV else None,
+            format=format.id,
+            matrix_s="709" if format.color_family == vs.YUV else None,
         )
 
     return video
@@ -0,0 +1,104 @@
+# runs custom weighting functions compiled by blur (src/common/expression.cpp). blur does all the parsing and passes
+# the postfix program in settings["weighting_program"], this only evaluates it so both sides agree on what a function
+# means. math errors give inf/nan like they do in c++ rather than raising
+
+import math
+
+
+def _safe(fn):
+    def wrapped(*args):
+        try:
+            return fn(*args)
+        except ZeroDivisionError:
+            return math.nan
+        except ValueError:
+            return math.nan
+        except OverflowError:
+            return math.inf
+
+    return wrapped
+
+
+def _divide(a, b):
+    if b == 0:
+        return math.nan if a == 0 or math.isnan(a) else math.copysign(math.inf, a)
+    return a / b
+
+
+def _modulo(a, b):
+    # python style, takes the sign of the divisor
+    if b == 0:
+        return math.nan
+    return a - math.floor(a / b) * b
+
+
+def _round(v):
+    # c++ rounds halves away from zero, python's round goes to even
+    return math.copysign(math.floor(abs(v) + 0.5), v)
+
+
+_BINARY = {
+    "add": lambda a, b: a + b,
+    "sub": lambda a, b: a - b,
+    "mul": lambda a, b: a * b,
+    "div": _divide,
+    "mod": _modulo,
+    "pow": _safe(math.pow),
+}
+
+_FUNCTIONS = {
+    "abs": abs,
+    "fabs": math.fabs,
+    "exp": _safe(math.exp),
+    "log": _safe(math.log),
+    "log2": _safe(math.log2),
+    "log10": _safe(math.log10),
+    "sqrt": _safe(math.sqrt),
+    "sin": _safe(math.sin),
+    "cos": _safe(math.cos),
+    "tan": _safe(math.tan),
+    "asin": _safe(math.asin),
+    "acos": _safe(math.acos),
+    "atan": math.atan,
+    "sinh": _safe(math.sinh),
+    "cosh": _safe(math.cosh),
+    "tanh": math.tanh,
+    "floor": _safe(math.floor),
+    "ceil": _safe(math.ceil),
+    "round": _safe(_round),
+    "pow": _safe(math.pow),
+    "min": min,
+    "max": max,
+    "atan2": math.atan2,
+    "fmod": _safe(math.fmod),
+}
+
+
+def evaluate(program, xs):
+    values = []
+
+    for x in xs:
+        stack = []
+
+        for instruction in program:
+            match instruction[0]:
+                case "const":
+                    stack.append(float(instruction[1]))
+                case "x":
+                    stack.append(float(x))
+                case "neg":
+                    stack.append(-stack.pop())
+                case "call1":
+                    stack.append(_FUNCTIONS[instruction[1]](stack.pop()))
+                case "call2":
+                    rhs = stack.pop()
+                    lhs = stack.pop()
+                    stack.append(_FUNCTIONS[instruction[1]](lhs, rhs))
+                case op:
+                    rhs = stack.pop()
+                    lhs = stack.pop()
+                    stack.append(_BINARY[op](lhs, rhs))
+
+        values.append(stack[0])
+
+    return values
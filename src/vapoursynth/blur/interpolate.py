@@ -107,7 +107,8 @@ def interpolate_svp(
         new_fps, preset, algorithm, blocksize, overlap, speed, masking, gpu
     )
 
-    # interpolate
+    # interpolate. vectors are analysed on every render: svp hands them to SmoothFps as in-process pointers
+    # (vectors["data"]) rather than frame data, so there's nothing that could be written to disk and mapped back in
     super = core.svp1.Super(video, super_string)
     vectors = core.svp1.Analyse(super["clip"], super["data"], video, vectors_string)
 
@@ -0,0 +1,41 @@
+from vapoursynth import core
+
+MB = 1024 * 1024
+
+
+def get_frame_size(clip) -> int:
+    # bytes needed to hold a single frame of the clip
+    format = clip.format
+    size = 0
+
+    for plane in range(format.num_planes):
+        width = clip.width
+        height = clip.height
+
+        if plane > 0:
+            width >>= format.subsampling_w
+            height >>= format.subsampling_h
+
+        size += width * height * format.bytes_per_sample
+
+    return size
+
+
+def apply_budget(clip, window: int, limit_mb: int, debug: bool = False):
+    # every worker thread can be holding its own blend window of source frames at once, so the cache needs room for
+    # about threads * window frames. when that doesn't fit in the limit we lower the thread count rather than letting
+    # vapoursynth thrash its cache or grow past the limit
+    frame_mb = max(get_frame_size(clip) / MB, 1e-3)
+    frames_per_thread = max(window, 1) + 1
+
+    max_threads = max(1, int(limit_mb // (frame_mb * frames_per_thread)))
+
+    if core.num_threads > max_threads:
+        if debug:
+            print(
+                f"memory limit of {limit_mb}mb fits {max_threads} threads with a {window} frame window, lowering from {core.num_threads}"
+            )
+
+        core.num_threads = max_threads
+
+    core.max_cache_size = limit_mb
@@ -0,0 +1,83 @@
+import hashlib
+import os
+from pathlib import Path
+
+from vapoursynth import core
+
+# source plugins build a frame index before they can seek, which means scanning the whole file. indexes are kept in
+# a cache directory owned by blur (which also limits its size), keyed on everything that would make an index stale
+
+
+def _plugin_version(plugin) -> str:
+    version = getattr(plugin, "version", None)
+    if version is not None:
+        return str(version)
+
+    # older vapoursynth versions don't expose plugin versions, the plugin binary changing is close enough
+    plugin_path = Path(plugin.plugin_path)
+    stat = plugin_path.stat()
+    return f"{plugin_path.name}-{stat.st_size}-{stat.st_mtime_ns}"
+
+
+def _index_path(cache_dir: Path, video_path: Path, plugin) -> Path:
+    stat = video_path.stat()
+
+    key = "|".join(
+        [
+            str(video_path.resolve()),
+            str(stat.st_size),
+            str(stat.st_mtime_ns),
+            plugin.namespace,
+            _plugin_version(plugin),
+        ]
+    )
+
+    return cache_dir / hashlib.sha1(key.encode("utf-8")).hexdigest()
+
+
+def _touch(index_path: Path):
+    # blur evicts the least recently used indexes, so mark this one as used. bestsource appends the track number and
+    # extension so match on prefix
+    for path in index_path.parent.glob(f"{index_path.name}*"):
+        try:
+            os.utime(path)
+        except OSError:
+            pass
+
+
+def load(
+    video_path: Path,
+    index_cache_dir: str | None = None,
+    lsmash: bool = False,
+    gpu_decoding: bool = False,
+):
+    index_path = None
+    if index_cache_dir:
+        cache_dir = Path(index_cache_dir)
+        cache_dir.mkdir(parents=True, exist_ok=True)
+
+        index_path = _index_path(
+            cache_dir, video_path, core.lsmas if lsmash else core.bs
+        )
+        _touch(index_path)
+
+    if lsmash:
+        if index_path is None:
+            return core.lsmas.LWLibavSource(
+                source=video_path, cache=0, prefer_hw=3 if gpu_decoding else 0
+            )
+
+        return core.lsmas.LWLibavSource(
+            source=video_path,
+            cache=1,
+            cachefile=f"{index_path}.lwi",
+            prefer_hw=3 if gpu_decoding else 0,
+        )
+
+    if index_path is None:
+        return core.bs.VideoSource(source=video_path, cachemode=0)
+
+    # cachemode 4: always read and write the index, at the absolute path given
+    return core.bs.VideoSource(
+        source=video_path, cachemode=4, cachepath=str(index_path)
+    )
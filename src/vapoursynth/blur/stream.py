@@ -0,0 +1,332 @@
+import json
+import math
+import subprocess
+import sys
+import threading
+from collections import OrderedDict
+from fractions import Fraction
+from pathlib import Path
+
+import vapoursynth as vs
+from vapoursynth import core
+
+import blur.utils as u
+
+# sequential source: ffmpeg decodes the input front to back and pipes y4m frames in, no index is built so frames
+# are available straight away and the input can be a pipe. only a bounded window of recent frames is kept, so this
+# only works when the rest of the script reads the clip roughly in order (blur windows, limited dedupe ranges)
+
+# y4m colourspace tag -> (subsampling w, subsampling h), None for greyscale. the bit depth comes from a 'p<bits>'
+# suffix on the tag, missing means 8 bit
+_Y4M_COLORSPACES = {
+    "420": (1, 1),
+    "420jpeg": (1, 1),
+    "420mpeg2": (1, 1),
+    "420paldv": (1, 1),
+    "422": (1, 0),
+    "444": (0, 0),
+    "mono": None,
+}
+
+# ffprobe colour names -> vapoursynth frame prop values (the values are the ones from ITU-T H.273)
+_MATRICES = {
+    "gbr": 0,
+    "bt709": 1,
+    "fcc": 4,
+    "bt470bg": 5,
+    "smpte170m": 6,
+    "smpte240m": 7,
+    "ycgco": 8,
+    "bt2020nc": 9,
+    "bt2020c": 10,
+}
+
+_TRANSFERS = {
+    "bt709": 1,
+    "gamma22": 4,
+    "gamma28": 5,
+    "smpte170m": 6,
+    "smpte240m": 7,
+    "linear": 8,
+    "log100": 9,
+    "log316": 10,
+    "iec61966-2-4": 11,
+    "bt1361e": 12,
+    "iec61966-2-1": 13,
+    "bt2020-10": 14,
+    "bt2020-12": 15,
+    "smpte2084": 16,
+    "arib-std-b67": 18,
+}
+
+_PRIMARIES = {
+    "bt709": 1,
+    "bt470m": 4,
+    "bt470bg": 5,
+    "smpte170m": 6,
+    "smpte240m": 7,
+    "film": 8,
+    "bt2020": 9,
+    "smpte428": 10,
+    "smpte431": 11,
+    "smpte432": 12,
+    "jedec-p22": 22,
+}
+
+# _ColorRange is 0 for full range and 1 for limited
+_RANGES = {"pc": 0, "tv": 1}
+
+PIPE_PATHS = {"-", "pipe:", "pipe:0"}
+
+
+def is_pipe(path) -> bool:
+    return str(path) in PIPE_PATHS or (Path(path).exists() and Path(path).is_fifo())
+
+
+def _parse_colorspace(tag: str):
+    bits = 8
+    for base in sorted(_Y4M_COLORSPACES, key=len, reverse=True):
+        if tag.startswith(base):
+            suffix = tag[len(base) :].removeprefix("p")
+            if suffix.isdigit():
+                bits = int(suffix)
+
+            subsampling = _Y4M_COLORSPACES[base]
+            if subsampling is None:
+                return core.query_video_format(
+                    vs.GRAY, vs.INTEGER, bits, 0, 0
+                ), bits
+
+            return core.query_video_format(
+                vs.YUV, vs.INTEGER, bits, subsampling[0], subsampling[1]
+            ), bits
+
+    raise u.BlurException(f"Unsupported y4m colourspace '{tag}'")
+
+
+def _probe(ffprobe_path: str, video_path) -> tuple[int | None, dict]:
+    # returns the frame count and the colour frame props the source filters would normally set.
+    # nb_frames is in the container header for most formats, fall back to duration * fps when it isn't. that estimate is
+    # rounded up since the decoder repeats the last frame if the stream runs out, where rounding down would drop frames
+    try:
+        output = subprocess.run(
+            [
+                ffprobe_path,
+                "-v",
+                "error",
+                "-select_streams",
+                "v:0",
+                "-show_entries",
+                "stream=nb_frames,r_frame_rate,duration,color_space,color_transfer,color_primaries,color_range:format=duration",
+                "-of",
+                "json",
+                str(video_path),
+            ],
+            capture_output=True,
+            check=True,
+        ).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return None, {}
+
+    info = json.loads(output)
+    stream = (info.get("streams") or [{}])[0]
+
+    props = {}
+    for prop, key, values in (
+        ("_Matrix", "color_space", _MATRICES),
+        ("_Transfer", "color_transfer", _TRANSFERS),
+        ("_Primaries", "color_primaries", _PRIMARIES),
+        ("_ColorRange", "color_range", _RANGES),
+    ):
+        value = values.get(stream.get(key))
+        if value is not None:
+            props[prop] = value
+
+    nb_frames = u.safe_int(stream.get("nb_frames"))
+    if nb_frames:
+        return nb_frames, props
+
+    try:
+        duration = float(
+            stream.get("duration") or info.get("format", {}).get("duration")
+        )
+        return math.ceil(duration * Fraction(stream["r_frame_rate"])), props
+    except (TypeError, ValueError, KeyError, ZeroDivisionError):
+        return None, props
+
+
+class _Decoder:
+    def __init__(self, ffmpeg_path: str, video_path, window: int):
+        pipe_input = str(video_path) in PIPE_PATHS
+
+        self.process = subprocess.Popen(
+            [
+                ffmpeg_path,
+                "-v",
+                "error",
+                "-i",
+                "pipe:0" if pipe_input else str(video_path),
+                "-map",
+                "0:v:0",
+                "-f",
+                "yuv4mpegpipe",
+                "-strict",
+                "-1",  # allows high bit depth y4m
+                "pipe:1",
+            ],
+            stdin=sys.stdin if pipe_input else subprocess.DEVNULL,
+            stdout=subprocess.PIPE,
+        )
+
+        self.window = window
+        self.frames = OrderedDict()
+        self.next_frame = 0
+        self.last_frame = None
+        self.lock = threading.Lock()
+
+        self._read_header()
+
+    def _read_line(self) -> bytes:
+        return self.process.stdout.readline().rstrip(b"\n")
+
+    def _read_exact(self, size: int) -> bytes | None:
+        data = self.process.stdout.read(size)
+        return data if len(data) == size else None
+
+    def _read_header(self):
+        header = self._read_line().decode("ascii").split(" ")
+        if not header or header[0] != "YUV4MPEG2":
+            raise u.BlurException("Failed to read stream header from ffmpeg")
+
+        self.fps = Fraction(30)
+        self.color_range = None
+        colorspace = "420"
+
+        for param in header[1:]:
+            key, value = param[0], param[1:]
+            match key:
+                case "W":
+                    self.width = int(value)
+                case "H":
+                    self.height = int(value)
+                case "F":
+                    num, den = value.split(":")
+                    self.fps = Fraction(int(num), int(den))
+                case "C":
+                    colorspace = value
+                case "X":
+                    # ffmpeg writes the range as an extension parameter
+                    match value:
+                        case "COLORRANGE=FULL":
+                            self.color_range = 0
+                        case "COLORRANGE=LIMITED":
+                            self.color_range = 1
+
+        self.format, bits = _parse_colorspace(colorspace)
+
+        bytes_per_sample = 1 if bits <= 8 else 2
+        self.plane_sizes = []
+        for plane in range(self.format.num_planes):
+            width, height = self.width, self.height
+            if plane > 0:
+                width >>= self.format.subsampling_w
+                height >>= self.format.subsampling_h
+            self.plane_sizes.append((width, height, width * height * bytes_per_sample))
+
+        self.frame_size = sum(size for _, _, size in self.plane_sizes)
+
+    def _decode_next(self) -> bool:
+        if not self._read_line().startswith(b"FRAME"):
+            return False
+
+        data = self._read_exact(self.frame_size)
+        if data is None:
+            return False
+
+        self.frames[self.next_frame] = data
+        self.last_frame = self.next_frame
+        self.next_frame += 1
+
+        while len(self.frames) > self.window:
+            self.frames.popitem(last=False)
+
+        return True
+
+    def get(self, n: int) -> bytes:
+        with self.lock:
+            while n >= self.next_frame:
+                if not self._decode_next():
+                    # the frame count was an estimate and the stream ended early, repeat the last frame
+                    if self.last_frame is None:
+                        raise u.BlurException("Stream ended before any frames")
+                    return self.frames[self.last_frame]
+
+            data = self.frames.get(n)
+            if data is None:
+                raise u.BlurException(
+                    f"Sequential decode can't go back to frame {n} (window is {self.window} frames, at {self.next_frame}). Turn off sequential decoding for this config"
+                )
+
+            return data
+
+
+def load(
+    video_path,
+    ffmpeg_path: str,
+    ffprobe_path: str,
+    window: int,
+    frame_count: int | None = None,
+):
+    # probing a pipe or fifo would consume the start of the stream before ffmpeg gets it, so for those the fps comes
+    # from the y4m header and the frame count has to be passed in
+    props = {}
+    if not is_pipe(video_path):
+        probed_count, props = _probe(ffprobe_path, video_path)
+        if frame_count is None:
+            frame_count = probed_count
+
+    if not frame_count:
+        raise u.BlurException(
+            "Sequential decode needs the number of frames (stream_frames) when reading from a pipe"
+            if is_pipe(video_path)
+            else "Sequential decode couldn't determine the number of frames, pass stream_frames"
+        )
+
+    try:
+        import numpy as np
+    except ImportError:
+        raise u.BlurException("Sequential decode requires numpy to be installed")
+
+    decoder = _Decoder(ffmpeg_path, video_path, window)
+
+    dtype = np.uint8 if decoder.format.bytes_per_sample == 1 else np.uint16
+
+    blank = core.std.BlankClip(
+        format=decoder.format.id,
+        width=decoder.width,
+        height=decoder.height,
+        length=frame_count,
+        fpsnum=decoder.fps.numerator,
+        fpsden=decoder.fps.denominator,
+    )
+
+    # the header is authoritative for range since it describes the frames actually being piped in
+    if decoder.color_range is not None:
+        props["_ColorRange"] = decoder.color_range
+
+    if props:
+        blank = core.std.SetFrameProps(blank, **props)
+
+    def fill_frame(n, f):
+        data = decoder.get(n)
+
+        fout = f.copy()
+        offset = 0
+        for plane, (width, height, size) in enumerate(decoder.plane_sizes):
+            source = np.frombuffer(data, dtype=dtype, count=width * height, offset=offset)
+            np.asarray(fout[plane])[:] = source.reshape(height, width)
+            offset += size
+
+        return fout
+
+    return core.std.ModifyFrame(blank, blank, fill_frame)
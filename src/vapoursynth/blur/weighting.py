@@ -2,6 +2,8 @@
 
 import math
 
+import blur.expression
+
 
 class InvalidCustomWeighting(Exception):
     def __init__(self, message="Invalid custom weighting function!"):
@@ -14,6 +16,18 @@ def scale_weights(frames):
     return [frame / tot for frame in frames]
 
 
+# same as weighting::normalise in blur: negative weights are shifted up, and all zero falls back to equal weights
+def normalise(weights):
+    lowest = min(weights)
+    if lowest < 0:
+        weights = [weight - lowest for weight in weights]
+
+    if sum(weights) <= 0:
+        return equal(len(weights))
+
+    return scale_weights(weights)
+
+
 # returns a list of values like below:
 # [0, 1, 2, 3, ..., frames] -> [a, ..., b]
 def scale_range(frames, a, b):
@@ -55,19 +69,14 @@ def pyramid_sym(frames):
     return scale_weights(val)
 
 
-def func_eval(func, nums):
-    try:
-        return eval(f"[({func}) for x in nums]")
-    except NameError as e:
+# program is the compiled function blur passes in settings["weighting_program"], see blur/expression.py
+def custom(frames, program, bound=[0, 1]):
+    if not program:
         raise InvalidCustomWeighting
 
-
-def custom(frames, func="", bound=[0, 1]):
     r = scale_range(frames, bound[0], bound[1])
-    val = func_eval(func, r)
-    if min(val) < 0:
-        val -= min(val)
-    return scale_weights(val)
+    val = blur.expression.evaluate(program, r)
+    return normalise(val)
 
 
 # stretch the given array (weights) to a specific length (frames)
@@ -81,7 +90,4 @@ def divide(frames, weights):
         scaled_index = int(r[x])
         val.append(weights[scaled_index])
 
-    if min(val) < 0:
-        val -= min(val)
-
-    return scale_weights(val)
+    return normalise(val)